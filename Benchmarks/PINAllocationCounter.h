@@ -0,0 +1,32 @@
+//
+//  PINAllocationCounter.h
+//  PINMessagePackBenchmarks
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Starts counting heap allocations in the whole process. Returns NO if
+ * something else, such as MallocStackLogging, already owns the hook.
+ *
+ * This uses the malloc logger hook that Instruments uses, which only
+ * Apple platforms have.
+ */
+FOUNDATION_EXTERN BOOL PINAllocationCounterStart(void);
+
+/**
+ * The number of allocations since counting started, including reallocations.
+ */
+FOUNDATION_EXTERN uint64_t PINAllocationCounterGetCount(void);
+
+/**
+ * The peak resident set size of the process so far, in bytes.
+ */
+FOUNDATION_EXTERN uint64_t PINGetPeakResidentBytes(void);
+
+NS_ASSUME_NONNULL_END
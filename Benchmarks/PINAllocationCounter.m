@@ -0,0 +1,68 @@
+//
+//  PINAllocationCounter.m
+//  PINMessagePackBenchmarks
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINAllocationCounter.h"
+
+#import <stdatomic.h>
+#import <sys/resource.h>
+
+static _Atomic(uint64_t) gAllocationCount;
+static _Atomic(bool) gCounting;
+
+NS_INLINE void PINAllocationCounterRecord(void)
+{
+  if (atomic_load_explicit(&gCounting, memory_order_relaxed)) {
+    atomic_fetch_add_explicit(&gAllocationCount, 1, memory_order_relaxed);
+  }
+}
+
+#if !defined(__APPLE__)
+#error "Allocation counting needs Apple's malloc logger."
+#endif
+
+// Exported by libmalloc for stack logging. Called after every allocation
+// and deallocation in every zone.
+typedef void (PINMallocLogger)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t skippedFrames);
+extern PINMallocLogger *malloc_logger;
+
+enum {
+  kPINMallocLogTypeAllocate = 2
+};
+
+static void PINAllocationLogger(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t skippedFrames)
+{
+  if (type & kPINMallocLogTypeAllocate) {
+    PINAllocationCounterRecord();
+  }
+}
+
+BOOL PINAllocationCounterStart(void)
+{
+  if (malloc_logger != NULL && malloc_logger != PINAllocationLogger) {
+    // Someone else, e.g. MallocStackLogging, already owns the hook.
+    return NO;
+  }
+  malloc_logger = PINAllocationLogger;
+  atomic_store(&gCounting, true);
+  return YES;
+}
+
+uint64_t PINAllocationCounterGetCount(void)
+{
+  return atomic_load(&gAllocationCount);
+}
+
+uint64_t PINGetPeakResidentBytes(void)
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  // In bytes on Apple platforms.
+  return (uint64_t)usage.ru_maxrss;
+}
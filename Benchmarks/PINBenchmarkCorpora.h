@@ -0,0 +1,36 @@
+//
+//  PINBenchmarkCorpora.h
+//  PINMessagePackBenchmarks
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A generated stream of MessagePack messages with a particular shape.
+ */
+@interface PINBenchmarkCorpus : NSObject
+
+@property (nonatomic, copy, readonly) NSString *name;
+
+/// The messages, back to back.
+@property (nonatomic, readonly) NSData *data;
+
+@property (nonatomic, readonly) NSUInteger messageCount;
+
+/// The number of values in all the messages, counting map keys,
+/// containers and their elements.
+@property (nonatomic, readonly) NSUInteger objectCount;
+
+/**
+ * All the corpora, generated from a fixed seed so that runs are comparable.
+ */
++ (NSArray<PINBenchmarkCorpus *> *)allCorpora;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,213 @@
+//
+//  PINBenchmarkCorpora.m
+//  PINMessagePackBenchmarks
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINBenchmarkCorpora.h"
+#import <PINMessagePack/PINMessagePack.h>
+
+/// A small deterministic generator, so corpora don't depend on the platform's random().
+typedef struct {
+  uint64_t state;
+} PINBenchmarkRandom;
+
+static uint64_t PINBenchmarkRandomNext(PINBenchmarkRandom *r)
+{
+  // xorshift64*
+  r->state ^= r->state >> 12;
+  r->state ^= r->state << 25;
+  r->state ^= r->state >> 27;
+  return r->state * 0x2545F4914F6CDD1DULL;
+}
+
+static NSUInteger PINBenchmarkRandomUniform(PINBenchmarkRandom *r, NSUInteger lower, NSUInteger upper)
+{
+  return lower + (NSUInteger)(PINBenchmarkRandomNext(r) % (upper - lower + 1));
+}
+
+static NSString *PINBenchmarkRandomString(PINBenchmarkRandom *r, NSUInteger length, BOOL ascii)
+{
+  static const char alphabet[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_ -";
+  static NSString *const nonASCII[] = { @"é", @"ü", @"ß", @"中", @"文", @"🙂" };
+  NSMutableString *s = [NSMutableString stringWithCapacity:length];
+  for (NSUInteger i = 0; i < length; i++) {
+    if (!ascii && PINBenchmarkRandomUniform(r, 0, 7) == 0) {
+      [s appendString:nonASCII[PINBenchmarkRandomUniform(r, 0, 5)]];
+    } else {
+      [s appendFormat:@"%c", alphabet[PINBenchmarkRandomUniform(r, 0, sizeof(alphabet) - 2)]];
+    }
+  }
+  return s;
+}
+
+/// Counts every value in the tree, including map keys and the containers themselves.
+static NSUInteger PINBenchmarkCountObjects(id object)
+{
+  NSUInteger count = 1;
+  if ([object isKindOfClass:[NSDictionary class]]) {
+    for (id key in object) {
+      count += PINBenchmarkCountObjects(key) + PINBenchmarkCountObjects(object[key]);
+    }
+  } else if ([object isKindOfClass:[NSArray class]]) {
+    for (id element in object) {
+      count += PINBenchmarkCountObjects(element);
+    }
+  }
+  return count;
+}
+
+@implementation PINBenchmarkCorpus
+
+- (instancetype)initWithName:(NSString *)name messages:(NSArray *)messages
+{
+  if (self = [super init]) {
+    _name = [name copy];
+    _messageCount = messages.count;
+    PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+    for (id message in messages) {
+      [packer encodeObject:message];
+      _objectCount += PINBenchmarkCountObjects(message);
+    }
+    NSAssert(packer.error == nil, @"Failed to encode corpus %@: %@", name, packer.error);
+    // Flatten once, so that every run starts from the same contiguous bytes.
+    _data = [[NSData alloc] initWithData:[packer encodedData]];
+  }
+  return self;
+}
+
++ (NSArray<PINBenchmarkCorpus *> *)allCorpora
+{
+  PINBenchmarkRandom r = { 0x9E3779B97F4A7C15ULL };
+  return @[
+    [[self alloc] initWithName:@"wide_maps" messages:@[ [self _wideMapsWithRandom:&r] ]],
+    [[self alloc] initWithName:@"deep_nesting" messages:@[ [self _deepNestingWithRandom:&r] ]],
+    [[self alloc] initWithName:@"string_heavy" messages:@[ [self _stringsWithRandom:&r] ]],
+    [[self alloc] initWithName:@"number_heavy" messages:@[ [self _numbersWithRandom:&r] ]],
+    [[self alloc] initWithName:@"large_bins" messages:@[ [self _largeBinsWithRandom:&r] ]],
+    [[self alloc] initWithName:@"small_messages" messages:[self _smallMessagesWithRandom:&r]]
+  ];
+}
+
+/// A list of records with many fields, like an API page of models.
++ (NSArray *)_wideMapsWithRandom:(PINBenchmarkRandom *)r
+{
+  NSMutableArray *keys = [NSMutableArray array];
+  for (NSUInteger k = 0; k < 64; k++) {
+    [keys addObject:[NSString stringWithFormat:@"field_%@_%lu", PINBenchmarkRandomString(r, 6, YES), (unsigned long)k]];
+  }
+  NSMutableArray *records = [NSMutableArray array];
+  for (NSUInteger i = 0; i < 2000; i++) {
+    NSMutableDictionary *record = [NSMutableDictionary dictionary];
+    for (NSUInteger k = 0; k < keys.count; k++) {
+      switch (k % 4) {
+        case 0:
+          record[keys[k]] = @(PINBenchmarkRandomNext(r) % 100000);
+          break;
+        case 1:
+          record[keys[k]] = PINBenchmarkRandomString(r, PINBenchmarkRandomUniform(r, 4, 24), YES);
+          break;
+        case 2:
+          record[keys[k]] = @(PINBenchmarkRandomUniform(r, 0, 1) == 1);
+          break;
+        default:
+          record[keys[k]] = @((double)PINBenchmarkRandomNext(r) / (double)UINT64_MAX);
+          break;
+      }
+    }
+    [records addObject:record];
+  }
+  return records;
+}
+
+/// Narrow trees that nest 48 levels deep.
++ (NSArray *)_deepNestingWithRandom:(PINBenchmarkRandom *)r
+{
+  NSMutableArray *trees = [NSMutableArray array];
+  for (NSUInteger i = 0; i < 2000; i++) {
+    id node = @(i);
+    for (NSUInteger depth = 0; depth < 48; depth++) {
+      if (PINBenchmarkRandomUniform(r, 0, 1)) {
+        node = @{ @"child": node, @"depth": @(depth) };
+      } else {
+        node = @[ node, @(depth) ];
+      }
+    }
+    [trees addObject:node];
+  }
+  return trees;
+}
+
+/// Mostly ASCII strings of mixed lengths, with some non-ASCII ones.
++ (NSArray *)_stringsWithRandom:(PINBenchmarkRandom *)r
+{
+  NSMutableArray *strings = [NSMutableArray array];
+  for (NSUInteger i = 0; i < 50000; i++) {
+    const NSUInteger length = (PINBenchmarkRandomUniform(r, 0, 9) == 0 ? PINBenchmarkRandomUniform(r, 256, 2048) : PINBenchmarkRandomUniform(r, 1, 64));
+    [strings addObject:PINBenchmarkRandomString(r, length, PINBenchmarkRandomUniform(r, 0, 4) != 0)];
+  }
+  return strings;
+}
+
+/// Arrays of integers of every width, and doubles.
++ (NSArray *)_numbersWithRandom:(PINBenchmarkRandom *)r
+{
+  NSMutableArray *arrays = [NSMutableArray array];
+  for (NSUInteger i = 0; i < 200; i++) {
+    NSMutableArray *numbers = [NSMutableArray array];
+    for (NSUInteger j = 0; j < 1000; j++) {
+      const uint64_t bits = PINBenchmarkRandomNext(r);
+      switch (j % 5) {
+        case 0:
+          [numbers addObject:@((int64_t)(bits % 128))];
+          break;
+        case 1:
+          [numbers addObject:@((int16_t)bits)];
+          break;
+        case 2:
+          [numbers addObject:@((int32_t)bits)];
+          break;
+        case 3:
+          [numbers addObject:@((int64_t)bits)];
+          break;
+        default:
+          [numbers addObject:@((double)bits / 1e9)];
+          break;
+      }
+    }
+    [arrays addObject:numbers];
+  }
+  return arrays;
+}
+
+/// A handful of large binary blobs, like images or protobuf payloads.
++ (NSArray *)_largeBinsWithRandom:(PINBenchmarkRandom *)r
+{
+  NSMutableArray *blobs = [NSMutableArray array];
+  for (NSUInteger i = 0; i < 32; i++) {
+    NSMutableData *blob = [NSMutableData dataWithLength:PINBenchmarkRandomUniform(r, 128 * 1024, 1024 * 1024)];
+    uint64_t *words = blob.mutableBytes;
+    for (NSUInteger w = 0; w < blob.length / sizeof(uint64_t); w++) {
+      words[w] = PINBenchmarkRandomNext(r);
+    }
+    [blobs addObject:@{ @"name": PINBenchmarkRandomString(r, 16, YES), @"bytes": blob }];
+  }
+  return blobs;
+}
+
+/// Many small events on one stream.
++ (NSArray *)_smallMessagesWithRandom:(PINBenchmarkRandom *)r
+{
+  NSArray *types = @[ @"impression", @"click", @"scroll", @"view_end" ];
+  NSMutableArray *messages = [NSMutableArray array];
+  for (NSUInteger i = 0; i < 50000; i++) {
+    [messages addObject:@{ @"type": types[PINBenchmarkRandomUniform(r, 0, types.count - 1)],
+                           @"id": @(PINBenchmarkRandomNext(r) >> 16),
+                           @"ts": @(1700000000 + i) }];
+  }
+  return messages;
+}
+
+@end
@@ -0,0 +1,37 @@
+//
+//  PINLockingBuffer.h
+//  PINMessagePackBenchmarks
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <PINMessagePack/PINBuffer.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * The buffer operations the throughput benchmark uses, so that it can
+ * run the same loop against both implementations.
+ */
+@protocol PINBenchmarkBuffer <NSObject>
+
+- (void)writeData:(NSData *)data;
+- (BOOL)read:(uint8_t *)buffer length:(NSUInteger)len;
+- (void)closeCompleted:(BOOL)completed;
+
+@end
+
+@interface PINBuffer (PINBenchmarkBuffer) <PINBenchmarkBuffer>
+@end
+
+/**
+ * PINBuffer as it was before the lock-free queue: an array of chunks
+ * guarded by a mutex, which the reader locks to take each chunk and again
+ * to drop it. Kept only so the benchmark can compare the two.
+ */
+@interface PINLockingBuffer : NSObject <PINBenchmarkBuffer>
+@end
+
+NS_ASSUME_NONNULL_END
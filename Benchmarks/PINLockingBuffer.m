@@ -0,0 +1,116 @@
+//
+//  PINLockingBuffer.m
+//  PINMessagePackBenchmarks
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINLockingBuffer.h"
+#import "PINMutexScope.h"
+
+#import <pthread.h>
+#import <stdatomic.h>
+
+@implementation PINBuffer (PINBenchmarkBuffer)
+@end
+
+@implementation PINLockingBuffer {
+  // Fixed
+  pthread_cond_t _cond;
+  pthread_mutex_t _mutex;
+
+  // Atomic
+  _Atomic(PINBufferState) _state;
+
+  // Only accessed from the reader thread. The current data.
+  __unsafe_unretained NSData *_reader_data;
+  NSUInteger _reader_dataLength;
+  NSUInteger _reader_byteIndex;
+
+  // Accessed from both threads – guarded by mutex.
+  NSMutableArray<NSData *> *_datas;
+}
+
+- (instancetype)init
+{
+  if (self = [super init]) {
+    pthread_cond_init(&_cond, NULL);
+    pthread_mutex_init(&_mutex, NULL);
+    _datas = [NSMutableArray array];
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  pthread_mutex_destroy(&_mutex);
+  pthread_cond_destroy(&_cond);
+}
+
+- (BOOL)_reader_acquireData
+{
+  if (_reader_data != nil) {
+    return YES;
+  }
+
+  PINMutexScope(&_mutex);
+  while (_datas.count == 0 && atomic_load(&_state) == PINBufferStateNormal) {
+    pthread_cond_wait(&_cond, &_mutex);
+  }
+  if (_datas.count == 0) {
+    return NO;
+  }
+  _reader_data = _datas[0];
+  _reader_dataLength = _reader_data.length;
+  _reader_byteIndex = 0;
+  return YES;
+}
+
+- (void)_reader_advance:(NSUInteger)len
+{
+  _reader_byteIndex += len;
+  if (_reader_byteIndex == _reader_dataLength) {
+    _reader_data = nil;
+    _reader_dataLength = 0;
+    _reader_byteIndex = 0;
+    PINMutexScope(&_mutex);
+    [_datas removeObjectAtIndex:0];
+  }
+}
+
+- (BOOL)read:(uint8_t *)buffer length:(NSUInteger)len
+{
+  NSUInteger needed = len;
+  while (needed > 0) {
+    if (![self _reader_acquireData]) {
+      return NO;
+    }
+    NSUInteger available = _reader_dataLength - _reader_byteIndex;
+    NSRange range = NSMakeRange(_reader_byteIndex, MIN(needed, available));
+    [_reader_data getBytes:buffer range:range];
+    [self _reader_advance:range.length];
+    needed -= range.length;
+    buffer += range.length;
+  }
+  return YES;
+}
+
+- (void)writeData:(NSData *)data
+{
+  NSData *copy = [data copy];
+  PINMutexScope(&_mutex);
+  [_datas addObject:copy];
+  if (_datas.count == 1) {
+    pthread_cond_signal(&_cond);
+  }
+}
+
+- (void)closeCompleted:(BOOL)completed
+{
+  PINMutexScope(&_mutex);
+  atomic_store(&_state, completed ? PINBufferStateCompleted : PINBufferStateError);
+  pthread_cond_signal(&_cond);
+}
+
+@end
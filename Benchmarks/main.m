@@ -0,0 +1,248 @@
+//
+//  main.m
+//  PINMessagePackBenchmarks
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <PINMessagePack/PINMessagePack.h>
+
+#import <time.h>
+
+#import "PINAllocationCounter.h"
+#import "PINBenchmarkCorpora.h"
+#import "PINLockingBuffer.h"
+
+/// Chunk size 0 means decoding straight from the data, without a buffer.
+static const NSUInteger kPINDefaultChunkSizes[] = { 0, 256, 4096, 65536 };
+
+/// The name that selects the buffer comparison with --corpus.
+static NSString * const kPINBufferBenchmarkName = @"buffer";
+
+/// Bytes pushed through a buffer per iteration of the buffer comparison.
+static const NSUInteger kPINBufferBenchmarkLength = 8 * 1024 * 1024;
+
+static void PINPrintUsage(void)
+{
+  fprintf(stderr,
+          "usage: pinmp-bench [--corpus NAME] [--chunk-size BYTES] [--min-time SECONDS]\n"
+          "\n"
+          "Decodes generated corpora through PINBuffer at several chunk sizes and\n"
+          "prints one JSON object per run to stdout. Chunk size 0 decodes straight\n"
+          "from the data. Peak RSS is for the whole process, so run one corpus and\n"
+          "chunk size per process to compare it across runs.\n"
+          "\n"
+          "At each nonzero chunk size it also streams bytes from a writer thread\n"
+          "through PINBuffer, and through the locking buffer it replaced, to compare\n"
+          "their throughput. Use --corpus buffer to run only that.\n");
+}
+
+static double PINNow(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/// Splits the data the way a network reader would hand it over.
+static NSArray<NSData *> *PINSplitIntoChunks(NSData *data, NSUInteger chunkSize)
+{
+  NSMutableArray *chunks = [NSMutableArray array];
+  for (NSUInteger offset = 0; offset < data.length; offset += chunkSize) {
+    [chunks addObject:[data subdataWithRange:NSMakeRange(offset, MIN(chunkSize, data.length - offset))]];
+  }
+  return chunks;
+}
+
+/// Decodes every message once, and returns how many there were, or NSNotFound on error.
+static NSUInteger PINDecodeOnce(PINBenchmarkCorpus *corpus, NSArray<NSData *> *chunks)
+{
+  PINMessageUnpacker *unpacker;
+  if (chunks) {
+    PINBuffer *buffer = [[PINBuffer alloc] init];
+    for (NSData *chunk in chunks) {
+      [buffer writeData:chunk];
+    }
+    [buffer closeCompleted:YES];
+    unpacker = [[PINMessageUnpacker alloc] initWithBuffer:buffer];
+  } else {
+    unpacker = [[PINMessageUnpacker alloc] initWithData:corpus.data];
+  }
+
+  __block NSUInteger count = 0;
+  [unpacker enumerateMessagesOfClass:Nil usingBlock:^(id message, BOOL *stop) {
+    count++;
+  }];
+  return (unpacker.error ? NSNotFound : count);
+}
+
+static NSDictionary *PINRunBenchmark(PINBenchmarkCorpus *corpus, NSUInteger chunkSize, double minimumTime, BOOL countsAllocations)
+{
+  NSArray<NSData *> *chunks = (chunkSize > 0 ? PINSplitIntoChunks(corpus.data, chunkSize) : nil);
+
+  // Warm up, and check that the corpus decodes.
+  @autoreleasepool {
+    if (PINDecodeOnce(corpus, chunks) != corpus.messageCount) {
+      fprintf(stderr, "error: %s failed to decode at chunk size %lu\n", corpus.name.UTF8String, (unsigned long)chunkSize);
+      return nil;
+    }
+  }
+
+  NSUInteger iterations = 0;
+  const uint64_t allocationsBefore = PINAllocationCounterGetCount();
+  const double start = PINNow();
+  double elapsed;
+  do {
+    @autoreleasepool {
+      PINDecodeOnce(corpus, chunks);
+    }
+    iterations++;
+    elapsed = PINNow() - start;
+  } while (elapsed < minimumTime);
+  const uint64_t allocations = PINAllocationCounterGetCount() - allocationsBefore;
+
+  const double bytes = (double)corpus.data.length * iterations;
+  const double objects = (double)corpus.objectCount * iterations;
+  return @{
+    @"corpus": corpus.name,
+    @"chunk_size": @(chunkSize),
+    @"bytes": @(corpus.data.length),
+    @"messages": @(corpus.messageCount),
+    @"objects": @(corpus.objectCount),
+    @"iterations": @(iterations),
+    @"seconds": @(elapsed),
+    @"mb_per_s": @(bytes / elapsed / 1e6),
+    @"objects_per_s": @(objects / elapsed),
+    @"allocations_per_iteration": (countsAllocations ? @((double)allocations / iterations) : [NSNull null]),
+    @"peak_rss_bytes": @(PINGetPeakResidentBytes())
+  };
+}
+
+/// Writes the chunks from another thread while reading them back in the
+/// small pieces a decoder asks for: a one-byte marker, then a payload.
+static BOOL PINStreamOnce(id<PINBenchmarkBuffer> buffer, NSArray<NSData *> *chunks)
+{
+  dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+    for (NSData *chunk in chunks) {
+      [buffer writeData:chunk];
+    }
+    [buffer closeCompleted:YES];
+  });
+
+  uint8_t piece[32];
+  NSUInteger remaining = kPINBufferBenchmarkLength;
+  while (remaining > 0) {
+    const NSUInteger length = MIN(remaining, (remaining % 2 ? 1 : sizeof(piece) - 1));
+    if (![buffer read:piece length:length]) {
+      return NO;
+    }
+    remaining -= length;
+  }
+  return YES;
+}
+
+static NSDictionary *PINRunBufferBenchmark(Class bufferClass, NSString *implementation, NSUInteger chunkSize, double minimumTime)
+{
+  NSArray<NSData *> *chunks = PINSplitIntoChunks([NSMutableData dataWithLength:kPINBufferBenchmarkLength], chunkSize);
+
+  NSUInteger iterations = 0;
+  const double start = PINNow();
+  double elapsed;
+  do {
+    @autoreleasepool {
+      if (!PINStreamOnce([[bufferClass alloc] init], chunks)) {
+        fprintf(stderr, "error: %s buffer ended early at chunk size %lu\n", implementation.UTF8String, (unsigned long)chunkSize);
+        return nil;
+      }
+    }
+    iterations++;
+    elapsed = PINNow() - start;
+  } while (elapsed < minimumTime);
+
+  return @{
+    @"corpus": kPINBufferBenchmarkName,
+    @"implementation": implementation,
+    @"chunk_size": @(chunkSize),
+    @"bytes": @(kPINBufferBenchmarkLength),
+    @"iterations": @(iterations),
+    @"seconds": @(elapsed),
+    @"mb_per_s": @((double)kPINBufferBenchmarkLength * iterations / elapsed / 1e6)
+  };
+}
+
+static void PINPrintResult(NSDictionary *result)
+{
+  NSData *json = [NSJSONSerialization dataWithJSONObject:result options:0 error:NULL];
+  fwrite(json.bytes, 1, json.length, stdout);
+  fputc('\n', stdout);
+  fflush(stdout);
+}
+
+int main(int argc, const char *argv[])
+{
+  @autoreleasepool {
+    NSString *corpusName = nil;
+    NSMutableArray<NSNumber *> *chunkSizes = [NSMutableArray array];
+    double minimumTime = 0.5;
+    for (int i = 1; i < argc; i++) {
+      const char *arg = argv[i];
+      if (i + 1 < argc && strcmp(arg, "--corpus") == 0) {
+        corpusName = @(argv[++i]);
+      } else if (i + 1 < argc && strcmp(arg, "--chunk-size") == 0) {
+        [chunkSizes addObject:@(strtoull(argv[++i], NULL, 10))];
+      } else if (i + 1 < argc && strcmp(arg, "--min-time") == 0) {
+        minimumTime = strtod(argv[++i], NULL);
+      } else {
+        PINPrintUsage();
+        return (strcmp(arg, "--help") == 0 ? 0 : 2);
+      }
+    }
+    if (chunkSizes.count == 0) {
+      for (size_t i = 0; i < sizeof(kPINDefaultChunkSizes) / sizeof(kPINDefaultChunkSizes[0]); i++) {
+        [chunkSizes addObject:@(kPINDefaultChunkSizes[i])];
+      }
+    }
+
+    const BOOL runsBuffers = (corpusName == nil || [corpusName isEqualToString:kPINBufferBenchmarkName]);
+    NSArray<PINBenchmarkCorpus *> *corpora = [PINBenchmarkCorpus allCorpora];
+    if (corpusName) {
+      corpora = [corpora filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"name == %@", corpusName]];
+      if (corpora.count == 0 && !runsBuffers) {
+        fprintf(stderr, "error: unknown corpus %s\n", corpusName.UTF8String);
+        return 2;
+      }
+    }
+
+    // Count after generating the corpora, so that only decoding is counted.
+    const BOOL countsAllocations = PINAllocationCounterStart();
+
+    int status = 0;
+    for (PINBenchmarkCorpus *corpus in corpora) {
+      for (NSNumber *chunkSize in chunkSizes) {
+        NSDictionary *result = PINRunBenchmark(corpus, chunkSize.unsignedIntegerValue, minimumTime, countsAllocations);
+        if (result == nil) {
+          status = 1;
+          continue;
+        }
+        PINPrintResult(result);
+      }
+    }
+
+    for (NSNumber *chunkSize in (runsBuffers ? chunkSizes : @[])) {
+      if (chunkSize.unsignedIntegerValue == 0) {
+        continue;
+      }
+      NSDictionary *lockFree = PINRunBufferBenchmark([PINBuffer class], @"lock-free", chunkSize.unsignedIntegerValue, minimumTime);
+      NSDictionary *locking = PINRunBufferBenchmark([PINLockingBuffer class], @"locking", chunkSize.unsignedIntegerValue, minimumTime);
+      if (lockFree == nil || locking == nil) {
+        status = 1;
+        continue;
+      }
+      PINPrintResult(lockFree);
+      PINPrintResult(locking);
+    }
+    return status;
+  }
+}
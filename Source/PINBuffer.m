@@ -7,31 +7,94 @@
 //
 
 #import "PINBuffer.h"
+#import "PINMappedFile.h"
 #import "PINMutexScope.h"
 
-#import <pthread/pthread.h>
+#import <pthread.h>
 #import <stdatomic.h>
+#import <errno.h>
+#import <math.h>
+#import <time.h>
+
+/**
+ * A node in the chunk queue. The queue is an intrusive linked list in the
+ * style of Dmitry Vyukov's MPSC queue: writers append with one atomic
+ * exchange, and the reader follows `next` pointers without locking.
+ */
+typedef struct PINBufferNode {
+  _Atomic(struct PINBufferNode *) next;
+  // +1. NULL for the initial stub, and for consumed nodes unless we preserve data.
+  CFTypeRef data;
+} PINBufferNode;
+
+static PINBufferNode *PINBufferNodeCreate(CFTypeRef data)
+{
+  PINBufferNode *node = malloc(sizeof(PINBufferNode));
+  atomic_init(&node->next, NULL);
+  node->data = data;
+  return node;
+}
+
+static void PINBufferNodeDestroy(PINBufferNode *node)
+{
+  if (node->data) {
+    CFRelease(node->data);
+  }
+  free(node);
+}
 
 @interface PINBuffer ()
 @end
 
+NS_INLINE void PINBufferCount(_Atomic(uint64_t) *counter, uint64_t n)
+{
+  atomic_fetch_add_explicit(counter, n, memory_order_relaxed);
+}
+
+static uint64_t PINBufferNanoseconds(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
 @implementation PINBuffer {
   // Fixed
   pthread_cond_t _cond;
+  pthread_cond_t _writerCond;
   pthread_mutex_t _mutex;
 
   // Atomic
   _Atomic(PINBufferState) _state;
-  
+  _Atomic(bool) _readerWaiting;
+  // Bytes written that the reader hasn't finished with, counted by chunk.
+  _Atomic(uint64_t) _bufferedByteCount;
+  // Set when buffered bytes reach the high-water mark, and cleared when
+  // they drain to the low-water mark.
+  _Atomic(bool) _aboveHighWaterMark;
+
+  // The last node in the queue. Writers swap themselves in here.
+  _Atomic(PINBufferNode *) _tail;
+
+  // Only accessed from the reader thread.
+  // The oldest node we still hold. Same as _head unless we preserve data.
+  PINBufferNode *_first;
+  // The node whose data we are reading, or finished reading.
+  PINBufferNode *_head;
+
+  // Counters, only updated if _collectsStatistics. Atomic because
+  // writers count their lock acquisitions too.
+  _Atomic(uint64_t) _stat_bytesConsumed;
+  _Atomic(uint64_t) _stat_chunksProcessed;
+  _Atomic(uint64_t) _stat_waitCount;
+  _Atomic(uint64_t) _stat_nanosecondsWaiting;
+  _Atomic(uint64_t) _stat_lockAcquisitions;
+
   // Only accessed from the reader thread. The current data.
   __unsafe_unretained NSData *_reader_data;
+  const uint8_t *_reader_bytes;
   NSUInteger _reader_dataLength;
   NSUInteger _reader_byteIndex;
-  NSUInteger _reader_dataIndex;
-  
-  // Accessed from both threads – guarded by mutex.
-  NSMutableArray<NSData *> *_datas;
-  NSUInteger _dataCount;
 }
 
 - (instancetype)init
@@ -39,113 +102,527 @@
   if (self = [super init]) {
     int result = pthread_cond_init(&_cond, NULL);
     NSAssert(result == noErr, @"Failed to create condition: %s", strerror(result));
+    result = pthread_cond_init(&_writerCond, NULL);
+    NSAssert(result == noErr, @"Failed to create condition: %s", strerror(result));
     result = pthread_mutex_init(&_mutex, NULL);
     NSAssert(result == noErr, @"Failed to create mutex: %s", strerror(result));
-    _datas = [NSMutableArray array];
+    PINBufferNode *stub = PINBufferNodeCreate(NULL);
+    _first = stub;
+    _head = stub;
+    atomic_init(&_tail, stub);
+  }
+  return self;
+}
+
+- (instancetype)initWithContentsOfFile:(NSString *)path error:(NSError **)error
+{
+  if (self = [self init]) {
+    if (!PINMappedFileWriteToBuffer(path, self, kPINMappedFileChunkLength, error)) {
+      return nil;
+    }
+    [self closeCompleted:YES];
   }
   return self;
 }
 
 - (void)dealloc
 {
+  PINBufferNode *node = _first;
+  while (node) {
+    PINBufferNode *next = atomic_load_explicit(&node->next, memory_order_relaxed);
+    PINBufferNodeDestroy(node);
+    node = next;
+  }
   int result = pthread_mutex_destroy(&_mutex);
   NSCAssert(result == noErr, @"error destroying mutex: %s", strerror(result));
   result = pthread_cond_destroy(&_cond);
   NSCAssert(result == noErr, @"error destroying cond: %s", strerror(result));
+  result = pthread_cond_destroy(&_writerCond);
+  NSCAssert(result == noErr, @"error destroying cond: %s", strerror(result));
 }
 
-- (BOOL)read:(uint8_t *)buffer length:(NSUInteger)len
+/// Makes sure we have a current data, waiting if needed. Empty chunks are skipped.
+/// Returns NO if the buffer closed before providing one.
+- (BOOL)_reader_acquireData
 {
-  NSUInteger needed = len;
-  while (needed > 0) {
-    
-    // Get a data if we don't have one.
-    if (_reader_data == nil) {
+  if (_reader_data != nil) {
+    return YES;
+  }
+
+  while (YES) {
+    PINBufferNode *next = atomic_load_explicit(&_head->next, memory_order_acquire);
+    if (next == NULL) {
+      // The queue is empty. Announce that we're waiting, then check again
+      // before sleeping. Writers check the flag after publishing, so
+      // one of us is guaranteed to see the other.
       PINMutexScope(&_mutex);
-      // While we're open and have no data, wait.
-      while (_dataCount <= _reader_dataIndex && self.state == PINBufferStateNormal) {
+      const uint64_t waitStart = (_collectsStatistics ? PINBufferNanoseconds() : 0);
+      atomic_store(&_readerWaiting, true);
+      while ((next = atomic_load(&_head->next)) == NULL && self.state == PINBufferStateNormal) {
         pthread_cond_wait(&_cond, &_mutex);
       }
-      
-      // We have data and/or we're closed. Handle each case.
-      if (_dataCount > _reader_dataIndex) {
-        _reader_data = [_datas objectAtIndex:_reader_dataIndex];
-      } else {
+      atomic_store(&_readerWaiting, false);
+      if (_collectsStatistics) {
+        PINBufferCount(&_stat_lockAcquisitions, 1);
+        PINBufferCount(&_stat_waitCount, 1);
+        PINBufferCount(&_stat_nanosecondsWaiting, PINBufferNanoseconds() - waitStart);
+      }
+
+      // We have data and/or we're closed. If we're closed, we're done.
+      if (next == NULL) {
         return NO;
       }
-      _reader_dataLength = _reader_data.length;
-      _reader_byteIndex = 0;
     }
-    
+
+    // Move onto the next node. Unless we're preserving, nothing
+    // references the nodes before it anymore.
+    if (!self.preserveData) {
+      while (_first != next) {
+        PINBufferNode *node = _first;
+        _first = atomic_load_explicit(&node->next, memory_order_relaxed);
+        PINBufferNodeDestroy(node);
+      }
+    }
+    _head = next;
+
+    // An empty write has nothing to read, and mustn't look like more to
+    // come, e.g. to -isAtEnd. Skip past it.
+    __unsafe_unretained NSData *data = (__bridge NSData *)next->data;
+    const NSUInteger length = data.length;
+    if (length == 0) {
+      if (!self.preserveData) {
+        CFRelease(next->data);
+        next->data = NULL;
+      }
+      continue;
+    }
+
+    if (_collectsStatistics) {
+      PINBufferCount(&_stat_chunksProcessed, 1);
+    }
+    _reader_data = data;
+    _reader_bytes = data.bytes;
+    _reader_dataLength = length;
+    _reader_byteIndex = 0;
+    return YES;
+  }
+}
+
+- (NSUInteger)_effectiveLowWaterMark
+{
+  const NSUInteger low = self.lowWaterMark;
+  const NSUInteger high = self.highWaterMark;
+  return (low > 0 && low < high ? low : high / 2);
+}
+
+/// Once buffered bytes drain to the low-water mark after reaching the
+/// high-water mark, wakes blocked writers and calls the handler.
+- (void)_resumeWritersIfDrained
+{
+  if (!atomic_load_explicit(&_aboveHighWaterMark, memory_order_relaxed)) {
+    return;
+  }
+  if (atomic_load(&_bufferedByteCount) > [self _effectiveLowWaterMark]) {
+    return;
+  }
+  // Only one thread gets to resume writers for each crossing.
+  if (!atomic_exchange(&_aboveHighWaterMark, false)) {
+    return;
+  }
+  {
+    PINMutexScope(&_mutex);
+    if (_collectsStatistics) {
+      PINBufferCount(&_stat_lockAcquisitions, 1);
+    }
+    pthread_cond_broadcast(&_writerCond);
+  }
+  dispatch_block_t handler = self.spaceAvailableHandler;
+  if (handler) {
+    handler();
+  }
+}
+
+/// Advances past `len` bytes of the current data, discarding it if we reach the end.
+- (void)_reader_advance:(NSUInteger)len
+{
+  _reader_byteIndex += len;
+  if (_collectsStatistics) {
+    PINBufferCount(&_stat_bytesConsumed, len);
+  }
+
+  // If we read to the end, discard this one.
+  if (_reader_byteIndex == _reader_dataLength) {
+    atomic_fetch_sub(&_bufferedByteCount, _reader_dataLength);
+    [self _resumeWritersIfDrained];
+    _reader_data = nil;
+    _reader_bytes = NULL;
+    _reader_dataLength = 0;
+    _reader_byteIndex = 0;
+    if (!self.preserveData) {
+      // The node itself stays until its successor arrives, but we can
+      // let go of the data now.
+      CFRelease(_head->data);
+      _head->data = NULL;
+    }
+  }
+}
+
+- (BOOL)read:(uint8_t *)buffer length:(NSUInteger)len
+{
+  NSUInteger needed = len;
+  while (needed > 0) {
+    // Get a data if we don't have one.
+    if (![self _reader_acquireData]) {
+      return NO;
+    }
+
     // Read data.
     NSUInteger available = _reader_dataLength - _reader_byteIndex;
-    NSRange range = NSMakeRange(_reader_byteIndex, MIN(needed, available));
-    [_reader_data getBytes:buffer range:range];
-    _reader_byteIndex = NSMaxRange(range);
+    NSUInteger n = MIN(needed, available);
+    memcpy(buffer, _reader_bytes + _reader_byteIndex, n);
+    [self _reader_advance:n];
+    needed -= n;
+    buffer += n;
+  }
+  return YES;
+}
+
+- (BOOL)isAtEnd
+{
+  return ![self _reader_acquireData];
+}
+
+- (BOOL)skip:(NSUInteger)len
+{
+  NSUInteger needed = len;
+  while (needed > 0) {
+    if (![self _reader_acquireData]) {
+      return NO;
+    }
+
+    // Skip as much of this data as we can, without touching the bytes.
+    NSUInteger available = _reader_dataLength - _reader_byteIndex;
+    NSUInteger skipped = MIN(needed, available);
+    [self _reader_advance:skipped];
+    needed -= skipped;
+  }
+  return YES;
+}
+
+/// Returns a view of the next `len` bytes of the current data, which must
+/// have that many left, retaining it. Then advances past them.
+- (NSData *)_reader_takeDataOfLength:(NSUInteger)len NS_RETURNS_RETAINED
+{
+  NSData *chunk = _reader_data;
+  NSData *result;
+  if (len == _reader_dataLength) {
+    result = chunk;
+  } else {
+    result = [[NSData alloc] initWithBytesNoCopy:(void *)(_reader_bytes + _reader_byteIndex) length:len deallocator:^(void *bytes, NSUInteger length) {
+      (void)chunk;
+    }];
+  }
+  [self _reader_advance:len];
+  return result;
+}
+
+- (NSData *)readDataOfLength:(NSUInteger)len NS_RETURNS_RETAINED
+{
+  NSData *first = nil;
+  dispatch_data_t result = nil;
+  NSUInteger needed = len;
+  while (needed > 0) {
+    if (![self _reader_acquireData]) {
+      return nil;
+    }
+    
+    NSUInteger available = _reader_dataLength - _reader_byteIndex;
+    NSUInteger n = MIN(needed, available);
+    NSData *piece = [self _reader_takeDataOfLength:n];
+    needed -= n;
     
-    // If we read to the end, discard this one.
-    if (_reader_byteIndex == _reader_dataLength) {
-      _reader_data = nil;
-      _reader_dataLength = 0;
-      _reader_byteIndex = 0;
-      if (self.preserveData) {
-        _reader_dataIndex += 1;
-      } else {
-        PINMutexScope(&_mutex);
-        _dataCount -= 1;
-        [_datas removeObjectAtIndex:_reader_dataIndex];
+    // Most values fit in one chunk. Only stitch if they don't.
+    if (first == nil) {
+      first = piece;
+    } else {
+      if (result == nil) {
+        result = [self _dispatchDataWithData:first];
       }
+      result = dispatch_data_create_concat(result, [self _dispatchDataWithData:piece]);
     }
-    needed -= range.length;
-    buffer += range.length;
   }
-  return YES;
+  
+  if (result) {
+    return (NSData *)result;
+  }
+  return first ?: [[NSData alloc] init];
 }
 
-- (NSData *)readAllData NS_RETURNS_RETAINED
+- (dispatch_data_t)_dispatchDataWithData:(NSData *)data
+{
+  return dispatch_data_create(data.bytes, data.length, NULL, ^{
+    (void)data;
+  });
+}
+
+- (NSData *)readRemainingData NS_RETURNS_RETAINED
+{
+  NSCAssert(self.state != PINBufferStateNormal, @"Attempt to read the remaining data from an open buffer.");
+  NSData *first = nil;
+  NSMutableData *result = nil;
+  while ([self _reader_acquireData]) {
+    NSData *piece = [self _reader_takeDataOfLength:_reader_dataLength - _reader_byteIndex];
+    if (first == nil) {
+      first = piece;
+    } else {
+      if (result == nil) {
+        result = [first mutableCopy];
+      }
+      [result appendData:piece];
+    }
+  }
+  return result ?: first ?: [[NSData alloc] init];
+}
+
+- (const void *)peekContiguousBytes:(NSUInteger)len
+{
+  // Don't wait for a chunk we don't need. It may never come.
+  if (len == 0) {
+    return "";
+  }
+  if (![self _reader_acquireData]) {
+    return NULL;
+  }
+  if (len > _reader_dataLength - _reader_byteIndex) {
+    return NULL;
+  }
+  return _reader_bytes + _reader_byteIndex;
+}
+
+- (const void *)peekAvailableBytes:(NSUInteger *)length
+{
+  if (![self _reader_acquireData]) {
+    *length = 0;
+    return NULL;
+  }
+  *length = _reader_dataLength - _reader_byteIndex;
+  return _reader_bytes + _reader_byteIndex;
+}
+
+- (void)consume:(NSUInteger)len
+{
+  if (len == 0) {
+    return;
+  }
+  NSCAssert(_reader_data != nil && len <= _reader_dataLength - _reader_byteIndex, @"Consuming more than was peeked.");
+  [self _reader_advance:len];
+}
+
+/// Returns every chunk that readAllData would cover, in order. Unless we
+/// preserve data, also drops them, since they all count as read.
+- (NSArray<NSData *> *)_takeAllChunks
 {
   NSCAssert(self.preserveData || self.state != PINBufferStateNormal, @"Attempt to read all data from an open, non-preserving buffer. This is a recipe for errors.");
-  PINMutexScope(&_mutex);
-  NSUInteger bufSize = 0;
-  for (NSData *data in _datas) {
-    bufSize += data.length;
+  NSMutableArray<NSData *> *chunks = [[NSMutableArray alloc] init];
+  PINBufferNode *last = _first;
+  for (PINBufferNode *node = _first; node != NULL; node = atomic_load_explicit(&node->next, memory_order_acquire)) {
+    if (node->data && ((__bridge NSData *)node->data).length > 0) {
+      [chunks addObject:(__bridge NSData *)node->data];
+    }
+    last = node;
   }
-  if (bufSize == 0) {
-    return [[NSData alloc] init];
+
+  if (!self.preserveData) {
+    // Everything unread counts as read now.
+    uint64_t unread = (_reader_data ? _reader_dataLength : 0);
+    for (PINBufferNode *node = atomic_load_explicit(&_head->next, memory_order_acquire); node != NULL; node = atomic_load_explicit(&node->next, memory_order_acquire)) {
+      if (node->data) {
+        unread += ((__bridge NSData *)node->data).length;
+      }
+      if (node == last) {
+        break;
+      }
+    }
+    atomic_fetch_sub(&_bufferedByteCount, unread);
+
+    // Everything has been read, so drop all but the last node, which
+    // writers may still link onto.
+    PINBufferNode *node = _first;
+    while (node != last) {
+      PINBufferNode *next = atomic_load_explicit(&node->next, memory_order_acquire);
+      PINBufferNodeDestroy(node);
+      node = next;
+    }
+    if (last->data) {
+      CFRelease(last->data);
+      last->data = NULL;
+    }
+    _first = last;
+    _head = last;
+    _reader_data = nil;
+    _reader_bytes = NULL;
+    _reader_dataLength = 0;
+    _reader_byteIndex = 0;
+    [self _resumeWritersIfDrained];
+  }
+  return chunks;
+}
+
+- (NSData *)readAllData NS_RETURNS_RETAINED
+{
+  NSArray<NSData *> *chunks = [self _takeAllChunks];
+  if (chunks.count <= 1) {
+    return chunks.firstObject ?: [[NSData alloc] init];
+  }
+
+  NSUInteger bufSize = 0;
+  for (NSData *chunk in chunks) {
+    bufSize += chunk.length;
   }
-  
   void *buf = malloc(bufSize);
   __block NSUInteger read = 0;
-  for (NSData *data in _datas) {
-    [data enumerateByteRangesUsingBlock:^(const void * _Nonnull bytes, NSRange byteRange, BOOL * _Nonnull stop) {
+  for (NSData *chunk in chunks) {
+    [chunk enumerateByteRangesUsingBlock:^(const void * _Nonnull bytes, NSRange byteRange, BOOL * _Nonnull stop) {
       memcpy(buf + read, bytes, byteRange.length);
       read += byteRange.length;
     }];
   }
-  if (!self.preserveData) {
-    [_datas removeAllObjects];
-  }
   return [[NSData alloc] initWithBytesNoCopy:buf length:bufSize];
 }
 
-- (void)writeData:(NSData *)data
+- (NSArray<NSData *> *)readAllChunks
+{
+  return [self _takeAllChunks];
+}
+
+/// Appends a chunk, which we take ownership of, and wakes the reader if needed.
+- (void)_writeChunk:(CFTypeRef)data
 {
-  NSData *copy = [data copy];
-  PINMutexScope(&_mutex);
   NSCAssert(self.state == PINBufferStateNormal, @"Writing after closing PINBuffer.");
-  _datas[_dataCount] = copy;
-  if (_dataCount == 0) {
+  PINBufferNode *node = PINBufferNodeCreate(data);
+
+  // Count the bytes before the reader can see them, so it never subtracts first.
+  const NSUInteger length = ((__bridge NSData *)data).length;
+  const uint64_t buffered = atomic_fetch_add(&_bufferedByteCount, length) + length;
+  const NSUInteger highWaterMark = self.highWaterMark;
+  if (highWaterMark > 0 && buffered >= highWaterMark) {
+    atomic_store(&_aboveHighWaterMark, true);
+    // The reader may have drained everything before we set the flag,
+    // in which case nobody else would clear it.
+    [self _resumeWritersIfDrained];
+  }
+
+  // Claim the tail, then link the previous tail to us. The reader may
+  // briefly see the old tail with no successor, which is the same as empty.
+  PINBufferNode *prev = atomic_exchange(&_tail, node);
+  atomic_store(&prev->next, node);
+
+  // Only take the lock if the reader is actually asleep.
+  if (atomic_load(&_readerWaiting)) {
+    PINMutexScope(&_mutex);
+    if (_collectsStatistics) {
+      PINBufferCount(&_stat_lockAcquisitions, 1);
+    }
     pthread_cond_signal(&_cond);
   }
-  _dataCount += 1;
+}
+
+/// Writes data we own. The reader needs each chunk's bytes in one piece,
+/// so noncontiguous data (e.g. dispatch_data from NSURLSession) is written
+/// one chunk per region rather than being flattened by -bytes later.
+- (void)_writeOwnedData:(NSData *)data
+{
+  __block NSUInteger regionCount = 0;
+  [data enumerateByteRangesUsingBlock:^(const void * _Nonnull bytes, NSRange byteRange, BOOL * _Nonnull stop) {
+    *stop = (++regionCount > 1);
+  }];
+  if (regionCount <= 1) {
+    [self _writeChunk:CFBridgingRetain(data)];
+    return;
+  }
+
+  [data enumerateByteRangesUsingBlock:^(const void * _Nonnull bytes, NSRange byteRange, BOOL * _Nonnull stop) {
+    if (byteRange.length > 0) {
+      [self _writeChunk:CFBridgingRetain([[NSData alloc] initWithBytesNoCopy:(void *)bytes length:byteRange.length deallocator:^(void *regionBytes, NSUInteger length) {
+        (void)data;
+      }])];
+    }
+  }];
+}
+
+- (void)writeData:(NSData *)data
+{
+  [self _writeOwnedData:[data copy]];
+}
+
+- (BOOL)writeData:(NSData *)data timeout:(NSTimeInterval)timeout
+{
+  if (atomic_load(&_aboveHighWaterMark)) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    // Clamp, so that e.g. DBL_MAX means forever rather than overflowing.
+    const NSTimeInterval seconds = MIN(MAX(timeout, 0), 1e9);
+    const uint64_t nanoseconds = (uint64_t)deadline.tv_nsec + (uint64_t)((seconds - floor(seconds)) * NSEC_PER_SEC);
+    deadline.tv_sec += (time_t)seconds + (time_t)(nanoseconds / NSEC_PER_SEC);
+    deadline.tv_nsec = (long)(nanoseconds % NSEC_PER_SEC);
+
+    PINMutexScope(&_mutex);
+    if (_collectsStatistics) {
+      PINBufferCount(&_stat_lockAcquisitions, 1);
+    }
+    while (atomic_load(&_aboveHighWaterMark) && self.state == PINBufferStateNormal) {
+      if (pthread_cond_timedwait(&_writerCond, &_mutex, &deadline) == ETIMEDOUT) {
+        return NO;
+      }
+    }
+    if (self.state != PINBufferStateNormal) {
+      return NO;
+    }
+  }
+  [self writeData:data];
+  return YES;
+}
+
+- (BOOL)hasSpaceAvailable
+{
+  return !atomic_load(&_aboveHighWaterMark);
+}
+
+- (NSUInteger)bufferedByteCount
+{
+  return (NSUInteger)atomic_load_explicit(&_bufferedByteCount, memory_order_relaxed);
+}
+
+- (void)writeDataNoCopy:(NSData *)data
+{
+  [self _writeOwnedData:data];
+}
+
+- (void)writeDispatchData:(dispatch_data_t)data
+{
+  // The reader needs each chunk's bytes in one piece. Asking a
+  // noncontiguous dispatch_data for -bytes would flatten it, so
+  // write each region as its own chunk instead.
+  dispatch_data_apply(data, ^bool(dispatch_data_t region, size_t offset, const void *buffer, size_t size) {
+    if (size > 0) {
+      [self _writeChunk:CFBridgingRetain([[NSData alloc] initWithBytesNoCopy:(void *)buffer length:size deallocator:^(void *bytes, NSUInteger length) {
+        (void)region;
+      }])];
+    }
+    return true;
+  });
 }
 
 - (void)closeCompleted:(BOOL)completed
 {
   NSCAssert(self.state == PINBufferStateNormal, @"Cannot close already-closed buffer.");
   PINMutexScope(&_mutex);
+  if (_collectsStatistics) {
+    PINBufferCount(&_stat_lockAcquisitions, 1);
+  }
   atomic_store(&_state, completed ? PINBufferStateCompleted : PINBufferStateError);
   pthread_cond_signal(&_cond);
+  pthread_cond_broadcast(&_writerCond);
 }
 
 - (PINBufferState)state
@@ -153,4 +630,15 @@
   return atomic_load(&_state);
 }
 
+- (PINBufferStatistics)statistics
+{
+  return (PINBufferStatistics){
+    .bytesConsumed = atomic_load_explicit(&_stat_bytesConsumed, memory_order_relaxed),
+    .chunksProcessed = atomic_load_explicit(&_stat_chunksProcessed, memory_order_relaxed),
+    .waitCount = atomic_load_explicit(&_stat_waitCount, memory_order_relaxed),
+    .nanosecondsWaiting = atomic_load_explicit(&_stat_nanosecondsWaiting, memory_order_relaxed),
+    .lockAcquisitions = atomic_load_explicit(&_stat_lockAcquisitions, memory_order_relaxed)
+  };
+}
+
 @end
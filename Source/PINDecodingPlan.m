@@ -0,0 +1,198 @@
+//
+//  PINDecodingPlan.m
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINDecodingPlan.h"
+#import "PINDecodingPlanField.h"
+
+#import <objc/runtime.h>
+
+/// Seeded FNV-1a.
+NS_INLINE uint32_t PINDecodingPlanHash(const char *bytes, size_t length, uint32_t seed)
+{
+  uint32_t hash = 2166136261u ^ seed;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (uint8_t)bytes[i];
+    hash *= 16777619u;
+  }
+  return hash ^ (hash >> 16);
+}
+
+/**
+ * Whether an object ivar is __strong, per the strong ivar layout of the
+ * class that declares it. The layout is a run of bytes, each skipping
+ * (high nibble) then scanning (low nibble) that many pointer-sized words.
+ * Weak, unsafe_unretained and manually managed ivars aren't scanned.
+ */
+static BOOL PINDecodingPlanIvarIsStrong(Class cls, Ivar ivar)
+{
+  Class owner = cls;
+  while (class_getSuperclass(owner) && class_getInstanceVariable(class_getSuperclass(owner), ivar_getName(ivar)) == ivar) {
+    owner = class_getSuperclass(owner);
+  }
+  const uint8_t *layout = class_getIvarLayout(owner);
+  if (layout == NULL) {
+    return NO;
+  }
+  const ptrdiff_t word = ivar_getOffset(ivar) / (ptrdiff_t)sizeof(void *);
+  ptrdiff_t index = 0;
+  for (uint8_t byte; (byte = *layout++) != 0; ) {
+    index += (byte >> 4);
+    if (index > word) {
+      return NO;
+    }
+    index += (byte & 0x0f);
+    if (index > word) {
+      return YES;
+    }
+  }
+  return NO;
+}
+
+/// How many seeds to try before growing the table.
+static const uint32_t kPINDecodingPlanSeedAttempts = 64;
+
+@implementation PINDecodingPlan {
+  PINDecodingPlanField *_fields;
+  NSUInteger _fieldCount;
+
+  // The perfect hash. Each slot holds a field index + 1, or 0 if empty.
+  uint16_t *_slots;
+  uint32_t _mask;
+  uint32_t _seed;
+}
+
+- (instancetype)initWithClass:(Class)cls ivarsForKeys:(NSDictionary<NSString *,NSString *> *)ivarsForKeys classesForKeys:(NSDictionary<NSString *,Class> *)classesForKeys
+{
+  if (self = [super init]) {
+    NSAssert(ivarsForKeys.count < UINT16_MAX, @"Too many keys in decoding plan.");
+    _fields = calloc(ivarsForKeys.count, sizeof(PINDecodingPlanField));
+    [ivarsForKeys enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSString *ivarName, BOOL *stop) {
+      PINDecodingPlanField field;
+      if ([self _getField:&field forKey:key ivarName:ivarName class:classesForKeys[key] inClass:cls]) {
+        self->_fields[self->_fieldCount++] = field;
+      }
+    }];
+    [self _buildPerfectHash];
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  for (NSUInteger i = 0; i < _fieldCount; i++) {
+    free((void *)_fields[i].key);
+  }
+  free(_fields);
+  free(_slots);
+}
+
+- (BOOL)_getField:(PINDecodingPlanField *)field forKey:(NSString *)key ivarName:(NSString *)ivarName class:(Class)valueClass inClass:(Class)cls
+{
+  Ivar ivar = class_getInstanceVariable(cls, ivarName.UTF8String);
+  if (ivar == NULL) {
+    NSAssert(NO, @"No ivar %@ in class %@.", ivarName, cls);
+    return NO;
+  }
+
+  const char *type = ivar_getTypeEncoding(ivar);
+  NSUInteger size;
+  NSGetSizeAndAlignment(type, &size, NULL);
+  switch (type[0]) {
+    case 'c':
+    case 's':
+    case 'i':
+    case 'l':
+    case 'q':
+      field->kind = PINDecodingFieldKindSigned;
+      break;
+    case 'C':
+    case 'S':
+    case 'I':
+    case 'L':
+    case 'Q':
+      field->kind = PINDecodingFieldKindUnsigned;
+      break;
+    case 'B':
+      field->kind = PINDecodingFieldKindBool;
+      break;
+    case 'f':
+      field->kind = PINDecodingFieldKindFloat;
+      break;
+    case 'd':
+      field->kind = PINDecodingFieldKindDouble;
+      break;
+    case '@':
+      // We store with a strong write, which would corrupt weak,
+      // unsafe_unretained and manually managed ivars.
+      if (!PINDecodingPlanIvarIsStrong(cls, ivar)) {
+        NSAssert(NO, @"Ivar %@ in class %@ is not a strong object reference.", ivarName, cls);
+        return NO;
+      }
+      field->kind = PINDecodingFieldKindObject;
+      break;
+    default:
+      NSAssert(NO, @"Unsupported type %s for ivar %@ in class %@.", type, ivarName, cls);
+      return NO;
+  }
+
+  NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+  char *keyBytes = malloc(MAX(keyData.length, 1));
+  memcpy(keyBytes, keyData.bytes, keyData.length);
+  field->key = keyBytes;
+  field->keyLength = (uint32_t)keyData.length;
+  field->size = (uint8_t)size;
+  field->offset = ivar_getOffset(ivar);
+  field->class = valueClass;
+  return YES;
+}
+
+/// Finds a seed and table size where no two keys share a slot.
+- (void)_buildPerfectHash
+{
+  uint32_t tableSize = 8;
+  while (tableSize < _fieldCount * 2) {
+    tableSize *= 2;
+  }
+
+  while (YES) {
+    _slots = realloc(_slots, tableSize * sizeof(uint16_t));
+    _mask = tableSize - 1;
+    for (_seed = 0; _seed < kPINDecodingPlanSeedAttempts; _seed++) {
+      memset(_slots, 0, tableSize * sizeof(uint16_t));
+      BOOL collided = NO;
+      for (NSUInteger i = 0; i < _fieldCount && !collided; i++) {
+        uint32_t slot = PINDecodingPlanHash(_fields[i].key, _fields[i].keyLength, _seed) & _mask;
+        if (_slots[slot] != 0) {
+          collided = YES;
+        } else {
+          _slots[slot] = (uint16_t)(i + 1);
+        }
+      }
+      if (!collided) {
+        return;
+      }
+    }
+    tableSize *= 2;
+  }
+}
+
+const PINDecodingPlanField *PINDecodingPlanGetField(PINDecodingPlan *plan, const char *key, size_t keyLength)
+{
+  uint16_t index = plan->_slots[PINDecodingPlanHash(key, keyLength, plan->_seed) & plan->_mask];
+  if (index == 0) {
+    return NULL;
+  }
+  // Unknown keys can land on any slot, so check that it's really ours.
+  const PINDecodingPlanField *field = &plan->_fields[index - 1];
+  if (field->keyLength != keyLength || memcmp(field->key, key, keyLength) != 0) {
+    return NULL;
+  }
+  return field;
+}
+
+@end
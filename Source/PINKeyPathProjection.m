@@ -0,0 +1,102 @@
+//
+//  PINKeyPathProjection.m
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINKeyPathProjection.h"
+
+@implementation PINKeyPathProjection {
+  // Parallel arrays. There are usually only a few children, so a linear
+  // scan with memcmp beats hashing a new string for every key.
+  NSMutableArray<NSString *> *_childKeys;
+  NSMutableArray<NSData *> *_childKeyBytes;
+  NSMutableArray<PINKeyPathProjection *> *_children;
+}
+
++ (instancetype)projectionWithKeyPaths:(NSArray<NSString *> *)keyPaths
+{
+  PINKeyPathProjection *root = [[PINKeyPathProjection alloc] init];
+  for (NSString *keyPath in keyPaths) {
+    if (![root _addKeyPath:keyPath]) {
+      return nil;
+    }
+  }
+  return root;
+}
+
+- (BOOL)hasChildren
+{
+  return (_children.count > 0);
+}
+
+- (PINKeyPathProjection *)_childForKey:(NSString *)key
+{
+  NSUInteger i = [_childKeys indexOfObject:key];
+  if (i != NSNotFound) {
+    return _children[i];
+  }
+  if (_children == nil) {
+    _childKeys = [[NSMutableArray alloc] init];
+    _childKeyBytes = [[NSMutableArray alloc] init];
+    _children = [[NSMutableArray alloc] init];
+  }
+  PINKeyPathProjection *child = [[PINKeyPathProjection alloc] init];
+  [_childKeys addObject:key];
+  [_childKeyBytes addObject:[key dataUsingEncoding:NSUTF8StringEncoding]];
+  [_children addObject:child];
+  return child;
+}
+
+- (PINKeyPathProjection *)_elementProjectionCreatingIfNeeded
+{
+  if (_elementProjection == nil) {
+    _elementProjection = [[PINKeyPathProjection alloc] init];
+  }
+  return _elementProjection;
+}
+
+- (BOOL)_addKeyPath:(NSString *)keyPath
+{
+  if (keyPath.length == 0) {
+    return NO;
+  }
+  PINKeyPathProjection *node = self;
+  for (NSString *component in [keyPath componentsSeparatedByString:@"."]) {
+    // Split off any [*] suffixes.
+    NSRange bracket = [component rangeOfString:@"["];
+    NSString *key = (bracket.location == NSNotFound ? component : [component substringToIndex:bracket.location]);
+    NSString *suffix = (bracket.location == NSNotFound ? @"" : [component substringFromIndex:bracket.location]);
+    if (key.length > 0) {
+      node = [node _childForKey:key];
+    } else if (suffix.length == 0 || node != self) {
+      // Empty components are only allowed for a leading [*].
+      return NO;
+    }
+    for (; suffix.length > 0; suffix = [suffix substringFromIndex:3]) {
+      if (![suffix hasPrefix:@"[*]"]) {
+        return NO;
+      }
+      node = [node _elementProjectionCreatingIfNeeded];
+    }
+  }
+  node->_keepsValue = YES;
+  return YES;
+}
+
+- (PINKeyPathProjection *)childForKeyBytes:(const char *)bytes length:(NSUInteger)length key:(NSString * __autoreleasing *)outKey
+{
+  NSUInteger count = _childKeyBytes.count;
+  for (NSUInteger i = 0; i < count; i++) {
+    NSData *keyBytes = _childKeyBytes[i];
+    if (keyBytes.length == length && memcmp(keyBytes.bytes, bytes, length) == 0) {
+      *outKey = _childKeys[i];
+      return _children[i];
+    }
+  }
+  return nil;
+}
+
+@end
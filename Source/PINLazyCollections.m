@@ -0,0 +1,192 @@
+//
+//  PINLazyCollections.m
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINLazyCollections.h"
+
+#import <pthread.h>
+#import <stdatomic.h>
+
+@implementation PINLazyDecodingContext {
+  NSDictionary *_extensionHandlers;
+  pthread_mutex_t _mutex;
+  // Created on first use, and only used with _mutex held.
+  PINMessageUnpacker *_unpacker;
+}
+
+- (instancetype)initWithData:(NSData *)data options:(PINLazyDecodingOptions)options
+{
+  if (self = [super init]) {
+    _data = data;
+    _options = options;
+    _extensionHandlers = options.extensionHandlers;
+    int result = pthread_mutex_init(&_mutex, NULL);
+    NSAssert(result == noErr, @"Failed to create mutex: %s", strerror(result));
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  int result = pthread_mutex_destroy(&_mutex);
+  NSCAssert(result == noErr, @"error destroying mutex: %s", strerror(result));
+}
+
+- (id)decodeObjectAtOffset:(NSUInteger)offset NS_RETURNS_RETAINED
+{
+  id decoded;
+  if (pthread_mutex_trylock(&_mutex) == 0) {
+    if (_unpacker == nil) {
+      _unpacker = PINLazyUnpackerCreate(self);
+    }
+    decoded = PINLazyUnpackerDecodeObject(_unpacker, offset);
+    pthread_mutex_unlock(&_mutex);
+  } else {
+    decoded = PINLazyUnpackerDecodeObject(PINLazyUnpackerCreate(self), offset);
+  }
+  return decoded ?: [NSNull null];
+}
+
+@end
+
+/// Returns the object in `slot`, decoding and publishing it if needed.
+/// If two threads race, one decode wins and the other is thrown away.
+static id PINLazySlotGetObject(_Atomic(CFTypeRef) *slot, PINLazyDecodingContext *context, NSUInteger offset)
+{
+  CFTypeRef obj = atomic_load_explicit(slot, memory_order_acquire);
+  if (obj) {
+    return (__bridge id)obj;
+  }
+
+  CFTypeRef decoded = (__bridge_retained CFTypeRef)[context decodeObjectAtOffset:offset];
+  CFTypeRef expected = NULL;
+  if (atomic_compare_exchange_strong_explicit(slot, &expected, decoded, memory_order_acq_rel, memory_order_acquire)) {
+    return (__bridge id)decoded;
+  }
+  CFRelease(decoded);
+  return (__bridge id)expected;
+}
+
+static void PINLazySlotsDestroy(_Atomic(CFTypeRef) *slots, NSUInteger count)
+{
+  for (NSUInteger i = 0; i < count; i++) {
+    CFTypeRef obj = atomic_load_explicit(&slots[i], memory_order_relaxed);
+    if (obj) {
+      CFRelease(obj);
+    }
+  }
+  free(slots);
+}
+
+@implementation PINLazyArray {
+  PINLazyDecodingContext *_context;
+  NSUInteger _count;
+  NSUInteger *_offsets;
+  _Atomic(CFTypeRef) *_objects;
+}
+
+- (instancetype)initWithContext:(PINLazyDecodingContext *)context offsets:(NSUInteger *)offsets count:(NSUInteger)count
+{
+  if (self = [super init]) {
+    _context = context;
+    _count = count;
+    _offsets = offsets;
+    _objects = calloc(count, sizeof(_Atomic(CFTypeRef)));
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  PINLazySlotsDestroy(_objects, _count);
+  free(_offsets);
+}
+
+- (NSUInteger)count
+{
+  return _count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index
+{
+  if (index >= _count) {
+    [NSException raise:NSRangeException format:@"Index %lu beyond bounds [0 .. %lu]", (unsigned long)index, (unsigned long)_count];
+  }
+  return PINLazySlotGetObject(&_objects[index], _context, _offsets[index]);
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+  // Immutable, so don't materialize a copy.
+  return self;
+}
+
+@end
+
+@implementation PINLazyDictionary {
+  PINLazyDecodingContext *_context;
+  NSUInteger _count;
+  NSUInteger *_offsets;
+  _Atomic(CFTypeRef) *_objects;
+
+  // Maps each key to its index. The values are plain integers.
+  CFMutableDictionaryRef _indexes;
+}
+
+- (instancetype)initWithContext:(PINLazyDecodingContext *)context retainedKeys:(CFTypeRef [])keys offsets:(NSUInteger *)offsets count:(NSUInteger)count
+{
+  if (self = [super init]) {
+    _context = context;
+    _count = count;
+    _offsets = offsets;
+    _objects = calloc(count, sizeof(_Atomic(CFTypeRef)));
+
+    // Like a regular dictionary, the last of any duplicate keys wins.
+    _indexes = CFDictionaryCreateMutable(NULL, count, &kCFTypeDictionaryKeyCallBacks, NULL);
+    for (NSUInteger i = 0; i < count; i++) {
+      CFDictionarySetValue(_indexes, keys[i], (const void *)i);
+      CFRelease(keys[i]);
+    }
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  PINLazySlotsDestroy(_objects, _count);
+  free(_offsets);
+  if (_indexes) {
+    CFRelease(_indexes);
+  }
+}
+
+- (NSUInteger)count
+{
+  return CFDictionaryGetCount(_indexes);
+}
+
+- (id)objectForKey:(id)key
+{
+  const void *index;
+  if (key == nil || !CFDictionaryGetValueIfPresent(_indexes, (__bridge CFTypeRef)key, &index)) {
+    return nil;
+  }
+  NSUInteger i = (NSUInteger)index;
+  return PINLazySlotGetObject(&_objects[i], _context, _offsets[i]);
+}
+
+- (NSEnumerator *)keyEnumerator
+{
+  return [(__bridge NSDictionary *)_indexes keyEnumerator];
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+  return self;
+}
+
+@end
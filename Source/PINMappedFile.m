@@ -0,0 +1,121 @@
+//
+//  PINMappedFile.m
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINMappedFile.h"
+#import "PINBuffer.h"
+
+#import <fcntl.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <unistd.h>
+
+/// Owns a mapping, and unmaps it when the last chunk that uses it goes away.
+@interface PINMapping : NSObject
+@property (nonatomic, readonly) void *bytes;
+@property (nonatomic, readonly) NSUInteger length;
+@end
+
+@implementation PINMapping
+
+- (instancetype)initWithBytes:(void *)bytes length:(NSUInteger)length
+{
+  if (self = [super init]) {
+    _bytes = bytes;
+    _length = length;
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  munmap(_bytes, _length);
+}
+
+@end
+
+static BOOL PINMappedFileFail(NSString *path, NSError **error)
+{
+  if (error) {
+    *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{ NSFilePathErrorKey: path }];
+  }
+  return NO;
+}
+
+/// Maps the whole file. An empty file succeeds with a NULL mapping, since mmap rejects length 0.
+static BOOL PINMappedFileMap(NSString *path, void **bytes, NSUInteger *length, NSError **error)
+{
+  const int fd = open(path.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return PINMappedFileFail(path, error);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    const int savedErrno = errno;
+    close(fd);
+    errno = savedErrno;
+    return PINMappedFileFail(path, error);
+  }
+  *bytes = NULL;
+  *length = (NSUInteger)st.st_size;
+  if (*length > 0) {
+    void *mapping = mmap(NULL, *length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      const int savedErrno = errno;
+      close(fd);
+      errno = savedErrno;
+      return PINMappedFileFail(path, error);
+    }
+    // Read ahead aggressively, and let pages behind us go first. This is only
+    // a hint, so failure doesn't matter.
+    madvise(mapping, *length, MADV_SEQUENTIAL);
+    *bytes = mapping;
+  }
+  // The mapping keeps the file alive.
+  close(fd);
+  return YES;
+}
+
+NSData *PINMappedFileCreateData(NSString *path, NSError **error) NS_RETURNS_RETAINED
+{
+  void *bytes;
+  NSUInteger length;
+  if (!PINMappedFileMap(path, &bytes, &length, error)) {
+    return nil;
+  }
+  if (length == 0) {
+    return [[NSData alloc] init];
+  }
+  return [[NSData alloc] initWithBytesNoCopy:bytes length:length deallocator:^(void *bytes, NSUInteger length) {
+    munmap(bytes, length);
+  }];
+}
+
+BOOL PINMappedFileWriteToBuffer(NSString *path, PINBuffer *buffer, NSUInteger chunkLength, NSError **error)
+{
+  NSCParameterAssert(chunkLength > 0 && chunkLength % (NSUInteger)sysconf(_SC_PAGESIZE) == 0);
+  void *bytes;
+  NSUInteger length;
+  if (!PINMappedFileMap(path, &bytes, &length, error)) {
+    return NO;
+  }
+  if (length == 0) {
+    return YES;
+  }
+  PINMapping *mapping = [[PINMapping alloc] initWithBytes:bytes length:length];
+  for (NSUInteger offset = 0; offset < length; offset += chunkLength) {
+    const NSUInteger chunkSize = MIN(chunkLength, length - offset);
+    NSData *chunk = [[NSData alloc] initWithBytesNoCopy:(uint8_t *)bytes + offset length:chunkSize deallocator:^(void *chunkBytes, NSUInteger chunkSize) {
+      // Clean file pages are refetched if anyone touches them again, so
+      // dropping them is safe even while other chunks are in use.
+      madvise(chunkBytes, chunkSize, MADV_DONTNEED);
+      (void)mapping;
+    }];
+    [buffer writeData:chunk];
+  }
+  return YES;
+}
@@ -0,0 +1,184 @@
+//
+//  PINMessageFramer.m
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINMessageFramer.h"
+
+NS_INLINE uint64_t PINReadBig16(const uint8_t *p)
+{
+  return ((uint64_t)p[0] << 8) | p[1];
+}
+
+NS_INLINE uint64_t PINReadBig32(const uint8_t *p)
+{
+  return ((uint64_t)p[0] << 24) | ((uint64_t)p[1] << 16) | ((uint64_t)p[2] << 8) | p[3];
+}
+
+/// The length of the header that starts with `marker`, including the marker
+/// and any fixed-size value, or 0 if the marker is invalid.
+static uint8_t PINHeaderLength(uint8_t marker)
+{
+  // Fixints, fixmaps, fixarrays and fixstrs.
+  if (marker <= 0xbf || marker >= 0xe0) {
+    return 1;
+  }
+  switch (marker) {
+    case 0xc0: // nil
+    case 0xc2: // false
+    case 0xc3: // true
+      return 1;
+    case 0xc4: // bin 8
+    case 0xcc: // uint 8
+    case 0xd0: // int 8
+    case 0xd4: // fixext 1
+    case 0xd5: // fixext 2
+    case 0xd6: // fixext 4
+    case 0xd7: // fixext 8
+    case 0xd8: // fixext 16
+    case 0xd9: // str 8
+      return 2;
+    case 0xc5: // bin 16
+    case 0xc7: // ext 8
+    case 0xcd: // uint 16
+    case 0xd1: // int 16
+    case 0xda: // str 16
+    case 0xdc: // array 16
+    case 0xde: // map 16
+      return 3;
+    case 0xc8: // ext 16
+      return 4;
+    case 0xc6: // bin 32
+    case 0xca: // float 32
+    case 0xce: // uint 32
+    case 0xd2: // int 32
+    case 0xdb: // str 32
+    case 0xdd: // array 32
+    case 0xdf: // map 32
+      return 5;
+    case 0xc9: // ext 32
+      return 6;
+    case 0xcb: // float 64
+    case 0xcf: // uint 64
+    case 0xd3: // int 64
+      return 9;
+    default:
+      return 0;
+  }
+}
+
+/// Reads how many values and payload bytes follow a complete header.
+static void PINHeaderGetContents(const uint8_t *header, uint64_t *children, uint64_t *payload)
+{
+  const uint8_t marker = header[0];
+  *children = 0;
+  *payload = 0;
+  if (marker >= 0x80 && marker <= 0x8f) {
+    *children = 2 * (uint64_t)(marker & 0x0f);
+    return;
+  }
+  if (marker >= 0x90 && marker <= 0x9f) {
+    *children = (marker & 0x0f);
+    return;
+  }
+  if (marker >= 0xa0 && marker <= 0xbf) {
+    *payload = (marker & 0x1f);
+    return;
+  }
+  switch (marker) {
+    case 0xc4:
+    case 0xc7:
+    case 0xd9:
+      *payload = header[1];
+      break;
+    case 0xc5:
+    case 0xc8:
+    case 0xda:
+      *payload = PINReadBig16(header + 1);
+      break;
+    case 0xc6:
+    case 0xc9:
+    case 0xdb:
+      *payload = PINReadBig32(header + 1);
+      break;
+    case 0xd4:
+      *payload = 1;
+      break;
+    case 0xd5:
+      *payload = 2;
+      break;
+    case 0xd6:
+      *payload = 4;
+      break;
+    case 0xd7:
+      *payload = 8;
+      break;
+    case 0xd8:
+      *payload = 16;
+      break;
+    case 0xdc:
+      *children = PINReadBig16(header + 1);
+      break;
+    case 0xdd:
+      *children = PINReadBig32(header + 1);
+      break;
+    case 0xde:
+      *children = 2 * PINReadBig16(header + 1);
+      break;
+    case 0xdf:
+      *children = 2 * PINReadBig32(header + 1);
+      break;
+    default:
+      break;
+  }
+}
+
+size_t PINMessageFramerScan(PINMessageFramer *framer, const uint8_t *bytes, size_t length, bool *complete)
+{
+  *complete = false;
+  size_t i = 0;
+  while (i < length) {
+    if (framer->payloadRemaining > 0) {
+      // Pass over the payload in one step.
+      const size_t n = (size_t)MIN(framer->payloadRemaining, (uint64_t)(length - i));
+      framer->payloadRemaining -= n;
+      i += n;
+    } else {
+      if (framer->headerLength == 0) {
+        if (framer->pending == 0) {
+          // The start of a new message.
+          framer->pending = 1;
+        }
+        framer->headerNeeded = PINHeaderLength(bytes[i]);
+        if (framer->headerNeeded == 0) {
+          framer->failed = true;
+          return i;
+        }
+      }
+
+      const size_t n = MIN((size_t)(framer->headerNeeded - framer->headerLength), length - i);
+      memcpy(framer->header + framer->headerLength, bytes + i, n);
+      framer->headerLength += n;
+      i += n;
+      if (framer->headerLength < framer->headerNeeded) {
+        // The header continues in the next chunk.
+        break;
+      }
+
+      uint64_t children, payload;
+      PINHeaderGetContents(framer->header, &children, &payload);
+      framer->headerLength = 0;
+      framer->pending = framer->pending - 1 + children;
+      framer->payloadRemaining = payload;
+    }
+
+    if (PINMessageFramerIsAtBoundary(framer)) {
+      *complete = true;
+      break;
+    }
+  }
+  return i;
+}
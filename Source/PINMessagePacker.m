@@ -0,0 +1,423 @@
+//
+//  PINMessagePacker.m
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINMessagePacker.h"
+#import "cmp.h"
+#import "PINMessagePackError.h"
+#import "PINBuffer.h"
+#import "PINTimestamp.h"
+
+static const NSUInteger kPINMessagePackerDefaultChunkSize = 64 * 1024;
+
+@interface PINMessagePacker ()
+- (BOOL)_emitChunk;
+@end
+
+@implementation PINMessagePacker {
+  cmp_ctx_t _cmpContext;
+  PINBuffer *_buffer;
+
+  // Chunks waiting for -encodedData. Only used when we don't have a buffer.
+  NSMutableArray<NSData *> *_chunks;
+
+  // The chunk we're currently filling.
+  uint8_t *_chunk;
+  size_t _chunkSize;
+  size_t _chunkLength;
+}
+
+/// Copy bytes into the current chunk, handing off chunks as they fill.
+/// Returns false if we couldn't allocate a chunk.
+static bool PINMessagePackerWrite(__unsafe_unretained PINMessagePacker *packer, const uint8_t *bytes, size_t count)
+{
+  while (count > 0) {
+    if (packer->_chunk == NULL) {
+      return false;
+    }
+    size_t available = packer->_chunkSize - packer->_chunkLength;
+    if (available == 0) {
+      [packer _emitChunk];
+      continue;
+    }
+    size_t n = MIN(count, available);
+    memcpy(packer->_chunk + packer->_chunkLength, bytes, n);
+    packer->_chunkLength += n;
+    bytes += n;
+    count -= n;
+  }
+  return true;
+}
+
+static size_t chunk_writer(cmp_ctx_t *ctx, const void *data, size_t count) {
+  __unsafe_unretained PINMessagePacker *packer = (__bridge PINMessagePacker *)ctx->buf;
+  return (PINMessagePackerWrite(packer, data, count) ? count : 0);
+}
+
+- (instancetype)init
+{
+  return [self initWithBuffer:nil chunkSize:0];
+}
+
+- (instancetype)initWithBuffer:(PINBuffer *)buffer
+{
+  return [self initWithBuffer:buffer chunkSize:0];
+}
+
+- (instancetype)initWithBuffer:(PINBuffer *)buffer chunkSize:(NSUInteger)chunkSize
+{
+  if (self = [super init]) {
+    _buffer = buffer;
+    if (buffer == nil) {
+      _chunks = [NSMutableArray array];
+    }
+    _chunkSize = (chunkSize > 0 ? chunkSize : kPINMessagePackerDefaultChunkSize);
+    _chunk = malloc(_chunkSize);
+    cmp_init(&_cmpContext, (__bridge void *)self, NULL, NULL, chunk_writer);
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  free(_chunk);
+}
+
+- (NSError *)error
+{
+  uint8_t error = (&_cmpContext)->error;
+  if (error) {
+    return [NSError errorWithDomain:PINMessagePackErrorDomain code:error userInfo:@{ NSDebugDescriptionErrorKey: @(cmp_strerror(&_cmpContext))}];
+  }
+  return nil;
+}
+
+/// Most of the time, pass NSNotFound to indicate that the error should be read from CMP.
+/// Only pass an error code if the error happened in our layer.
+- (void)failWithErrorCode:(NSInteger)errorCode
+{
+  if (errorCode != NSNotFound) {
+    (&_cmpContext)->error = errorCode;
+  }
+  NSCAssert(NO, @"MessagePack encoding error: %s", cmp_strerror(&_cmpContext));
+}
+
+#pragma mark - Chunks
+
+/// Hand off the current chunk without copying and start a new one.
+/// Returns NO if the new chunk couldn't be allocated, after which writes fail.
+- (BOOL)_emitChunk
+{
+  NSData *chunk = [[NSData alloc] initWithBytesNoCopy:_chunk length:_chunkLength freeWhenDone:YES];
+  _chunk = malloc(_chunkSize);
+  _chunkLength = 0;
+  [self _outputChunk:chunk];
+  return (_chunk != NULL);
+}
+
+- (void)_outputChunk:(NSData *)chunk
+{
+  if (_buffer) {
+    [_buffer writeDataNoCopy:chunk];
+  } else {
+    [_chunks addObject:chunk];
+  }
+}
+
+- (void)flush
+{
+  if (_chunkLength == 0) {
+    return;
+  }
+
+  // If the chunk is mostly full, hand it off. Otherwise copy out the used
+  // part so that we can keep filling the chunk we have.
+  if (_chunkLength >= _chunkSize / 2) {
+    [self _emitChunk];
+  } else {
+    NSData *copy = [[NSData alloc] initWithBytes:_chunk length:_chunkLength];
+    _chunkLength = 0;
+    [self _outputChunk:copy];
+  }
+}
+
+- (NSData *)encodedData NS_RETURNS_RETAINED
+{
+  NSCAssert(_buffer == nil, @"Attempt to get encoded data from a packer that writes to a buffer.");
+  [self flush];
+  NSArray<NSData *> *chunks = [_chunks copy];
+  [_chunks removeAllObjects];
+
+  switch (chunks.count) {
+    case 0:
+      return [[NSData alloc] init];
+    case 1:
+      return chunks[0];
+    default: {
+      // Stitch the chunks together without flattening them.
+      dispatch_data_t result = dispatch_data_empty;
+      for (NSData *chunk in chunks) {
+        dispatch_data_t region = dispatch_data_create(chunk.bytes, chunk.length, NULL, ^{
+          (void)chunk;
+        });
+        result = dispatch_data_create_concat(result, region);
+      }
+      return (NSData *)result;
+    }
+  }
+}
+
+#pragma mark - PINStreamingEncoder
+
+- (void)encodeMapHeaderWithCount:(NSUInteger)count
+{
+  if (count > UINT32_MAX) {
+    [self failWithErrorCode:PINMessagePackErrorMapTooLong];
+    return;
+  }
+  if (!cmp_write_map(&_cmpContext, (uint32_t)count)) {
+    [self failWithErrorCode:NSNotFound];
+  }
+}
+
+- (void)encodeArrayHeaderWithCount:(NSUInteger)count
+{
+  if (count > UINT32_MAX) {
+    [self failWithErrorCode:PINMessagePackErrorArrayTooLong];
+    return;
+  }
+  if (!cmp_write_array(&_cmpContext, (uint32_t)count)) {
+    [self failWithErrorCode:NSNotFound];
+  }
+}
+
+- (void)encodeKey:(const char *)key length:(NSUInteger)keyLen
+{
+  if (keyLen > UINT32_MAX) {
+    [self failWithErrorCode:PINMessagePackErrorStringDataTooLong];
+    return;
+  }
+  if (!cmp_write_str(&_cmpContext, key, (uint32_t)keyLen)) {
+    [self failWithErrorCode:NSNotFound];
+  }
+}
+
+- (void)encodeNil
+{
+  if (!cmp_write_nil(&_cmpContext)) {
+    [self failWithErrorCode:NSNotFound];
+  }
+}
+
+- (void)encodeBOOL:(BOOL)value
+{
+  if (!cmp_write_bool(&_cmpContext, value)) {
+    [self failWithErrorCode:NSNotFound];
+  }
+}
+
+- (void)encodeDouble:(double)value
+{
+  if (!cmp_write_double(&_cmpContext, value)) {
+    [self failWithErrorCode:NSNotFound];
+  }
+}
+
+- (void)encodeInteger:(NSInteger)value
+{
+  if (!cmp_write_integer(&_cmpContext, (int64_t)value)) {
+    [self failWithErrorCode:NSNotFound];
+  }
+}
+
+- (void)encodeObject:(id)object
+{
+  static Class numberClass;
+  static Class stringClass;
+  static Class dataClass;
+  static Class arrayClass;
+  static Class dictionaryClass;
+  static Class setClass;
+  static Class dateClass;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    numberClass = [NSNumber class];
+    stringClass = [NSString class];
+    dataClass = [NSData class];
+    arrayClass = [NSArray class];
+    dictionaryClass = [NSDictionary class];
+    setClass = [NSSet class];
+    dateClass = [NSDate class];
+  });
+
+  if (object == nil || object == (__bridge id)kCFNull) {
+    [self encodeNil];
+  } else if ([object isKindOfClass:stringClass]) {
+    [self _encodeString:object];
+  } else if ([object isKindOfClass:numberClass]) {
+    [self _encodeNumber:object];
+  } else if ([object isKindOfClass:dictionaryClass]) {
+    NSDictionary *dictionary = object;
+    [self encodeMapHeaderWithCount:dictionary.count];
+    [dictionary enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop) {
+      [self encodeObject:key];
+      [self encodeObject:obj];
+    }];
+  } else if ([object isKindOfClass:arrayClass] || [object isKindOfClass:setClass]) {
+    [self encodeArrayHeaderWithCount:[(NSArray *)object count]];
+    for (id obj in object) {
+      [self encodeObject:obj];
+    }
+  } else if ([object isKindOfClass:dataClass]) {
+    [self _encodeData:object];
+  } else if ([object isKindOfClass:dateClass]) {
+    [self _encodeDate:object];
+  } else if ([object conformsToProtocol:@protocol(PINStreamingEncoding)]) {
+    [(id<PINStreamingEncoding>)object encodeWithStreamingEncoder:self];
+  } else {
+    [self failWithErrorCode:PINMessagePackErrorInvalidType];
+  }
+}
+
+- (void)_encodeNumber:(NSNumber *)number
+{
+  CFNumberRef cfNumber = (__bridge CFNumberRef)number;
+  bool success;
+  if (CFGetTypeID(cfNumber) == CFBooleanGetTypeID()) {
+    success = cmp_write_bool(&_cmpContext, CFBooleanGetValue((CFBooleanRef)cfNumber));
+  } else if (CFNumberIsFloatType(cfNumber)) {
+    CFNumberType type = CFNumberGetType(cfNumber);
+    if (type == kCFNumberFloat32Type || type == kCFNumberFloatType) {
+      float f;
+      CFNumberGetValue(cfNumber, kCFNumberFloatType, &f);
+      success = cmp_write_float(&_cmpContext, f);
+    } else {
+      double d;
+      CFNumberGetValue(cfNumber, kCFNumberDoubleType, &d);
+      success = cmp_write_double(&_cmpContext, d);
+    }
+  } else if (number.objCType[0] == 'Q') {
+    // Only values above INT64_MAX are stored as unsigned.
+    success = cmp_write_uinteger(&_cmpContext, number.unsignedLongLongValue);
+  } else {
+    success = cmp_write_integer(&_cmpContext, number.longLongValue);
+  }
+  if (!success) {
+    [self failWithErrorCode:NSNotFound];
+  }
+}
+
+- (void)_encodeString:(NSString *)string
+{
+  CFStringRef str = (__bridge CFStringRef)string;
+  const CFIndex length = CFStringGetLength(str);
+
+  // Fast path for strings stored as ASCII, which is already UTF-8 with one
+  // byte per character. Take the length from the string, not strlen, since
+  // strings can contain NULs.
+  const char *cStr = CFStringGetCStringPtr(str, kCFStringEncodingASCII);
+  if (cStr != NULL) {
+    if ((uint64_t)length > UINT32_MAX) {
+      [self failWithErrorCode:PINMessagePackErrorStringDataTooLong];
+    } else if (!cmp_write_str(&_cmpContext, cStr, (uint32_t)length)) {
+      [self failWithErrorCode:NSNotFound];
+    }
+    return;
+  }
+
+  // Measure before writing the header. Conversion stops early at characters
+  // UTF-8 can't represent, like lone surrogates, so fail on those rather than
+  // write a header that doesn't match the bytes.
+  const CFRange range = CFRangeMake(0, length);
+  CFIndex byteCount = 0;
+  if (CFStringGetBytes(str, range, kCFStringEncodingUTF8, 0, false, NULL, 0, &byteCount) != length) {
+    [self failWithErrorCode:PINMessagePackErrorInvalidType];
+    return;
+  }
+  if ((uint64_t)byteCount > UINT32_MAX) {
+    [self failWithErrorCode:PINMessagePackErrorStringDataTooLong];
+    return;
+  }
+  if (!cmp_write_str_marker(&_cmpContext, (uint32_t)byteCount)) {
+    [self failWithErrorCode:NSNotFound];
+    return;
+  }
+
+  // If it fits in a chunk, transcode straight into the chunk.
+  CFIndex used = 0;
+  if ((size_t)byteCount <= _chunkSize) {
+    if (_chunk == NULL || (_chunkSize - _chunkLength < (size_t)byteCount && ![self _emitChunk])) {
+      [self failWithErrorCode:PINMessagePackErrorWritingData];
+      return;
+    }
+    CFStringGetBytes(str, range, kCFStringEncodingUTF8, 0, false, _chunk + _chunkLength, byteCount, &used);
+    _chunkLength += used;
+  } else {
+    UInt8 *bytes = malloc(byteCount);
+    if (bytes == NULL) {
+      [self failWithErrorCode:PINMessagePackErrorWritingData];
+      return;
+    }
+    CFStringGetBytes(str, range, kCFStringEncodingUTF8, 0, false, bytes, byteCount, &used);
+    const bool written = PINMessagePackerWrite(self, bytes, used);
+    free(bytes);
+    if (!written) {
+      [self failWithErrorCode:PINMessagePackErrorWritingData];
+      return;
+    }
+  }
+  if (used != byteCount) {
+    [self failWithErrorCode:PINMessagePackErrorWritingData];
+  }
+}
+
+- (void)_encodeDate:(NSDate *)date
+{
+  int64_t seconds;
+  uint32_t nanoseconds;
+  if (!PINTimestampFromAbsoluteTime(CFDateGetAbsoluteTime((__bridge CFDateRef)date), &seconds, &nanoseconds)) {
+    [self failWithErrorCode:PINMessagePackErrorInvalidType];
+    return;
+  }
+  uint8_t bytes[12];
+  const size_t length = PINTimestampEncode(seconds, nanoseconds, bytes);
+  if (!cmp_write_ext(&_cmpContext, kPINTimestampExtensionType, (uint32_t)length, bytes)) {
+    [self failWithErrorCode:NSNotFound];
+  }
+}
+
+- (void)_encodeData:(NSData *)data
+{
+  NSUInteger length = data.length;
+  if (length > UINT32_MAX) {
+    [self failWithErrorCode:PINMessagePackErrorBinaryDataTooLong];
+    return;
+  }
+  if (!cmp_write_bin_marker(&_cmpContext, (uint32_t)length)) {
+    [self failWithErrorCode:NSNotFound];
+    return;
+  }
+
+  // Large blobs become chunks of their own, instead of being copied.
+  if (length >= _chunkSize) {
+    [self flush];
+    [self _outputChunk:[data copy]];
+    return;
+  }
+  __block BOOL written = YES;
+  [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+    if (!PINMessagePackerWrite(self, bytes, byteRange.length)) {
+      written = NO;
+      *stop = YES;
+    }
+  }];
+  if (!written) {
+    [self failWithErrorCode:PINMessagePackErrorWritingData];
+  }
+}
+
+@end
@@ -0,0 +1,102 @@
+//
+//  PINMessagePushUnpacker.m
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINMessagePushUnpacker.h"
+#import "PINMessagePackError.h"
+#import "PINMessageFramer.h"
+
+@interface PINMessageUnpacker (PINPushDecoding)
+
+/// Points the unpacker at one message, from `offset` up to `length` in `data`.
+- (void)_resetWithData:(NSData *)data length:(NSUInteger)length offset:(NSUInteger)offset;
+
+@end
+
+@implementation PINMessagePushUnpacker {
+  Class _class;
+  void (^_messageHandler)(id);
+  PINMessageFramer _framer;
+
+  // The start of a message that spans chunks.
+  NSMutableData *_partialMessage;
+}
+
+- (instancetype)initWithClass:(Class)class messageHandler:(void (^)(id))messageHandler
+{
+  if (self = [super init]) {
+    _class = class;
+    _messageHandler = [messageHandler copy];
+    _unpacker = [[PINMessageUnpacker alloc] initWithBytes:NULL length:0];
+  }
+  return self;
+}
+
+- (BOOL)isAtMessageBoundary
+{
+  return PINMessageFramerIsAtBoundary(&_framer);
+}
+
+- (BOOL)consumeData:(NSData *)data
+{
+  if (_error) {
+    return NO;
+  }
+
+  data = [data copy];
+  const uint8_t *bytes = data.bytes;
+  const NSUInteger length = data.length;
+  NSUInteger offset = 0;
+  while (offset < length) {
+    const NSUInteger start = offset;
+    bool complete;
+    offset += PINMessageFramerScan(&_framer, bytes + start, length - start, &complete);
+    if (_framer.failed) {
+      _error = [NSError errorWithDomain:PINMessagePackErrorDomain code:PINMessagePackErrorInvalidType userInfo:nil];
+      NSAssert(NO, @"MessagePack parsing error: invalid type marker.");
+      return NO;
+    }
+
+    // Check before gathering, so that a huge length in a header can't
+    // make us buffer without bound.
+    const NSUInteger messageLength = _partialMessage.length + (offset - start);
+    if (_maximumMessageLength > 0 && messageLength > _maximumMessageLength) {
+      _partialMessage = nil;
+      _error = [NSError errorWithDomain:PINMessagePackErrorDomain code:PINMessagePackErrorInputTooLarge userInfo:nil];
+      return NO;
+    }
+
+    if (!complete) {
+      // The message continues in the next chunk.
+      if (_partialMessage == nil) {
+        _partialMessage = [[NSMutableData alloc] init];
+      }
+      [_partialMessage appendBytes:bytes + start length:offset - start];
+      break;
+    }
+
+    @autoreleasepool {
+      if (_partialMessage) {
+        [_partialMessage appendBytes:bytes + start length:offset - start];
+        NSData *message = _partialMessage;
+        _partialMessage = nil;
+        [_unpacker _resetWithData:message length:message.length offset:0];
+      } else {
+        [_unpacker _resetWithData:data length:offset offset:start];
+      }
+      id message = [_unpacker decodeObjectOfClass:_class];
+      _error = _unpacker.error;
+      if (_error) {
+        return NO;
+      }
+      _messageHandler(message);
+    }
+  }
+  return YES;
+}
+
+@end
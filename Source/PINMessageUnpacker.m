@@ -11,6 +11,36 @@
 #import "PINMessagePackError.h"
 #import "PINCollections.h"
 #import "PINBuffer.h"
+#import "PINByteCursor.h"
+#import "PINStringTable.h"
+#import "PINScratch.h"
+#import "PINLazyCollections.h"
+#import "PINKeyPathProjection.h"
+#import "PINDecodingPlanField.h"
+#import "PINNumericArrays.h"
+#import "PINStringCreation.h"
+#import "PINTimestamp.h"
+#import "PINNumberCache.h"
+#import "PINMappedFile.h"
+#import "PINNumberFormatting.h"
+
+#import <objc/runtime.h>
+#import <stdatomic.h>
+
+/// Bounds for the intern table, so that unique strings can't make it grow forever.
+static const NSUInteger kPINMaxInternedStringCount = 2048;
+static const NSUInteger kPINMaxInternedKeyLength = 128;
+
+/// Strings and collections up to these sizes are decoded on the stack.
+/// Bigger ones use the scratch stack, since their sizes come off the wire.
+enum {
+  kPINStackStringLength = 256,
+  kPINStackCollectionCount = 16
+};
+
+/// Arrays need at least this many elements and bytes to be decoded concurrently.
+static const NSUInteger kPINConcurrentArrayMinimumCount = 64;
+static const NSUInteger kPINConcurrentArrayMinimumLength = 64 * 1024;
 
 /// Checks that the class is either Nil or the specified one.
 /// On fail, report error and return nil.
@@ -20,11 +50,150 @@
     return nil; \
   }
 
+/// Whether a type marker starts a map or an array: fixmap, fixarray, array 16/32 or map 16/32.
+NS_INLINE BOOL PINMarkerIsMapOrArray(uint8_t marker)
+{
+  return (marker >= 0x80 && marker <= 0x9f) || (marker >= 0xdc && marker <= 0xdf);
+}
+
+NS_INLINE BOOL PINLazyDecodingOptionsEqual(PINLazyDecodingOptions a, PINLazyDecodingOptions b)
+{
+  return (a.forcesMapKeysToString == b.forcesMapKeysToString
+          && a.internsMapKeys == b.internsMapKeys
+          && a.decodesBinaryDataWithoutCopying == b.decodesBinaryDataWithoutCopying
+          && a.maximumInternedValueLength == b.maximumInternedValueLength
+          && a.extensionHandlers == b.extensionHandlers);
+}
+
 @implementation PINMessageUnpacker {
   cmp_ctx_t _cmpContext;
+  
+  // Streaming input. Nil when decoding from contiguous bytes.
   PINBuffer *_buffer;
+  // A completed buffer whose remaining data we switched over to reading
+  // directly, for lazy decoding. Kept so that errors still consult it.
+  PINBuffer *_drainedBuffer;
+  
+  // Contiguous input. _data is nil if the caller owns the bytes.
+  NSData *_data;
+  PINByteCursor _cursor;
+  
+  // Created on first use, if interning is enabled.
+  PINStringTable *_stringTable;
+  
+  // Temporary storage for decoding strings and collections, reused across nesting levels.
+  PINScratch _scratch;
+  
+  // Registered extension handlers by type. Replaced, not mutated, so that
+  // lazy collections can share it.
+  NSDictionary<NSNumber *, PINExtensionHandler> *_extensionHandlers;
   
   uint32_t _pendingMapCount;
+  
+  // How many arrays, maps and custom objects we're inside. Values decoded at
+  // depth 0 are messages.
+  NSUInteger _depth;
+  PINDecodingStatistics _statistics;
+  
+  // Shared by the lazy collections we decode, and reused while it lives.
+  __weak PINLazyDecodingContext *_lazyContext;
+  // Set for unpackers that decode a context's elements. Nobody is left to
+  // check their errors, so invalid elements read as NSNull without asserting.
+  BOOL _decodesLazyElements;
+}
+
+static _Atomic(PINMessageTraceFunction) gTraceFunction;
+static void *gTraceContext;
+
+void PINMessageUnpackerSetTraceFunction(PINMessageTraceFunction function, void *context)
+{
+  gTraceContext = context;
+  atomic_store(&gTraceFunction, function);
+}
+
+NS_INLINE void PINUnpackerBeginMessage(PINMessageUnpacker *self)
+{
+  if (self->_depth > 0) {
+    return;
+  }
+  PINMessageTraceFunction trace = atomic_load_explicit(&gTraceFunction, memory_order_relaxed);
+  if (trace) {
+    trace(PINMessageTraceEventBegin, self, gTraceContext);
+  }
+}
+
+NS_INLINE void PINUnpackerEndMessage(PINMessageUnpacker *self)
+{
+  if (self->_depth > 0) {
+    return;
+  }
+  if (self->_collectsStatistics) {
+    self->_statistics.messageCount++;
+  }
+  PINMessageTraceFunction trace = atomic_load_explicit(&gTraceFunction, memory_order_relaxed);
+  if (trace) {
+    trace(PINMessageTraceEventEnd, self, gTraceContext);
+  }
+}
+
+static void PINUnpackerRecordObject(PINMessageUnpacker *self, cmp_type type)
+{
+  PINMessagePackType family;
+  switch (type) {
+    case CMP_TYPE_NIL:
+      family = PINMessagePackTypeNil;
+      break;
+    case CMP_TYPE_BOOLEAN:
+      family = PINMessagePackTypeBoolean;
+      break;
+    case CMP_TYPE_FLOAT:
+    case CMP_TYPE_DOUBLE:
+      family = PINMessagePackTypeFloat;
+      break;
+    case CMP_TYPE_FIXSTR:
+    case CMP_TYPE_STR8:
+    case CMP_TYPE_STR16:
+    case CMP_TYPE_STR32:
+      family = PINMessagePackTypeString;
+      break;
+    case CMP_TYPE_BIN8:
+    case CMP_TYPE_BIN16:
+    case CMP_TYPE_BIN32:
+      family = PINMessagePackTypeBinary;
+      break;
+    case CMP_TYPE_FIXARRAY:
+    case CMP_TYPE_ARRAY16:
+    case CMP_TYPE_ARRAY32:
+      family = PINMessagePackTypeArray;
+      break;
+    case CMP_TYPE_FIXMAP:
+    case CMP_TYPE_MAP16:
+    case CMP_TYPE_MAP32:
+      family = PINMessagePackTypeMap;
+      break;
+    case CMP_TYPE_FIXEXT1:
+    case CMP_TYPE_FIXEXT2:
+    case CMP_TYPE_FIXEXT4:
+    case CMP_TYPE_FIXEXT8:
+    case CMP_TYPE_FIXEXT16:
+    case CMP_TYPE_EXT8:
+    case CMP_TYPE_EXT16:
+    case CMP_TYPE_EXT32:
+      family = PINMessagePackTypeExtension;
+      break;
+    default:
+      family = PINMessagePackTypeInteger;
+      break;
+  }
+  self->_statistics.objectCounts[family]++;
+  self->_statistics.maximumDepth = MAX(self->_statistics.maximumDepth, self->_depth);
+}
+
+NS_INLINE void PINUnpackerRecordContainer(PINMessageUnpacker *self, NSUInteger count)
+{
+  if (self->_collectsStatistics) {
+    self->_statistics.largestContainerCount = MAX(self->_statistics.largestContainerCount, count);
+  }
 }
 
 static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
@@ -32,15 +201,67 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
   return (bool)[buffer read:data length:limit];
 }
 
+static bool stream_skipper(cmp_ctx_t *ctx, size_t count) {
+  __unsafe_unretained PINBuffer *buffer = (__bridge PINBuffer *)ctx->buf;
+  return (bool)[buffer skip:count];
+}
+
+static bool data_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
+  return PINByteCursorRead((PINByteCursor *)ctx->buf, data, limit);
+}
+
+static bool data_skipper(cmp_ctx_t *ctx, size_t count) {
+  return PINByteCursorSkip((PINByteCursor *)ctx->buf, count);
+}
+
 - (instancetype)initWithBuffer:(PINBuffer *)buffer
 {
   if (self = [super init]) {
     _buffer = buffer;
-    cmp_init(&_cmpContext, (__bridge void *)buffer, stream_reader, NULL, NULL);
+    _decodingConcurrency = 1;
+    cmp_init(&_cmpContext, (__bridge void *)buffer, stream_reader, stream_skipper, NULL);
+  }
+  return self;
+}
+
+- (instancetype)initWithBytes:(const void *)bytes length:(NSUInteger)length
+{
+  if (self = [super init]) {
+    _cursor = PINByteCursorMake(bytes, length);
+    _decodingConcurrency = 1;
+    cmp_init(&_cmpContext, &_cursor, data_reader, data_skipper, NULL);
+  }
+  return self;
+}
+
+- (instancetype)initWithData:(NSData *)data
+{
+  // Immutable data is retained here, not copied. Noncontiguous data
+  // will be flattened once by -bytes.
+  NSData *copy = [data copy];
+  if (self = [self initWithBytes:copy.bytes length:copy.length]) {
+    _data = copy;
   }
   return self;
 }
 
+- (instancetype)initWithContentsOfFile:(NSString *)path error:(NSError **)error
+{
+  NSData *data = PINMappedFileCreateData(path, error);
+  if (data == nil) {
+    return nil;
+  }
+  return [self initWithData:data];
+}
+
+- (void)dealloc
+{
+  if (_stringTable) {
+    PINStringTableDestroy(_stringTable);
+  }
+  PINScratchDestroy(&_scratch);
+}
+
 - (NSError *)error
 {
   uint8_t error = (&_cmpContext)->error;
@@ -50,6 +271,17 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
   return nil;
 }
 
+- (void)setCollectsStatistics:(BOOL)collectsStatistics
+{
+  _collectsStatistics = collectsStatistics;
+  (_buffer ?: _drainedBuffer).collectsStatistics = collectsStatistics;
+}
+
+- (PINDecodingStatistics)statistics
+{
+  return _statistics;
+}
+
 /// Most of the time, pass NSNotFound to indicate that the error should be read from CMP.
 /// Only pass an error code if the error happened in our layer.
 - (void)failWithErrorCode:(NSInteger)errorCode
@@ -59,6 +291,9 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
   } else {
     errorCode = (&_cmpContext)->error;
   }
+  if (_decodesLazyElements) {
+    return;
+  }
   
   switch (errorCode) {
     case PINMessagePackErrorReadingData:
@@ -67,7 +302,7 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
     case PINMessagePackErrorReadingTypeMarker:
       // For errors reading, check if the buffer was interrupted.
       // If so, there was probably an I/O error and we shouldn't assert.
-      if (_buffer.state == PINBufferStateError) {
+      if ((_buffer ?: _drainedBuffer).state == PINBufferStateError) {
         return;
       }
     default:
@@ -76,6 +311,136 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
   }
 }
 
+/// Reads raw payload bytes, e.g. after a str or bin header.
+- (BOOL)_readBytes:(void *)buf length:(size_t)len
+{
+  if (!_cmpContext.read(&_cmpContext, buf, len)) {
+    [self failWithErrorCode:PINMessagePackErrorReadingData];
+    return NO;
+  }
+  return YES;
+}
+
+/// Returns the next `len` payload bytes in place, or NULL if they aren't contiguous.
+/// Follow with -_consumeBytes: once you're done with them.
+- (const void *)_peekBytes:(size_t)len
+{
+  if (_buffer) {
+    return [_buffer peekContiguousBytes:len];
+  }
+  return PINByteCursorPeek(&_cursor, len);
+}
+
+/// Returns all the input we can read in place, or NULL if there is none.
+/// Follow with -_consumeBytes:.
+- (const void *)_peekAvailableBytes:(NSUInteger *)length
+{
+  if (_buffer) {
+    return [_buffer peekAvailableBytes:length];
+  }
+  *length = PINByteCursorRemaining(&_cursor);
+  return (*length > 0 ? _cursor.bytes + _cursor.offset : NULL);
+}
+
+- (void)_consumeBytes:(size_t)len
+{
+  if (_buffer) {
+    [_buffer consume:len];
+  } else {
+    _cursor.offset += len;
+  }
+}
+
+/// Returns the next `len` payload bytes, in place if they're contiguous or else
+/// copied into scratch space. Returns NULL on error. Follow with -_endReadingBytes:inPlace:mark:.
+- (const char *)_beginReadingBytes:(size_t)len inPlace:(BOOL *)inPlace mark:(PINScratchMark *)mark
+{
+  *mark = PINScratchGetMark(&_scratch);
+  const char *bytes = [self _peekBytes:len];
+  *inPlace = (bytes != NULL);
+  if (bytes) {
+    return bytes;
+  }
+  
+  char *buf = PINScratchAlloc(&_scratch, len);
+  if (buf == NULL) {
+    [self failWithErrorCode:PINMessagePackErrorStringDataTooLong];
+    return NULL;
+  }
+  if (![self _readBytes:buf length:len]) {
+    PINScratchReset(&_scratch, *mark);
+    return NULL;
+  }
+  return buf;
+}
+
+- (void)_endReadingBytes:(size_t)len inPlace:(BOOL)inPlace mark:(PINScratchMark)mark
+{
+  if (inPlace) {
+    [self _consumeBytes:len];
+  } else {
+    PINScratchReset(&_scratch, mark);
+  }
+}
+
+/// Reads `len` payload bytes as a view that retains the input, or nil on error.
+/// Only valid if we retain the input, i.e. we have a buffer or a data.
+- (NSData *)_readDataViewOfLength:(size_t)len NS_RETURNS_RETAINED
+{
+  if (_buffer) {
+    NSData *result = [_buffer readDataOfLength:len];
+    if (result == nil) {
+      [self failWithErrorCode:PINMessagePackErrorReadingData];
+    }
+    return result;
+  }
+  
+  const void *bytes = PINByteCursorPeek(&_cursor, len);
+  if (bytes == NULL) {
+    [self failWithErrorCode:PINMessagePackErrorReadingData];
+    return nil;
+  }
+  _cursor.offset += len;
+  NSData *data = _data;
+  return [[NSData alloc] initWithBytesNoCopy:(void *)bytes length:len deallocator:^(void *bytes, NSUInteger length) {
+    (void)data;
+  }];
+}
+
+- (NSString *)_stringWithBytes:(const char *)bytes length:(uint32_t)len isKey:(BOOL)isKey NS_RETURNS_RETAINED
+{
+  // Reuse an interned string if we have one.
+  const NSUInteger internLimit = (isKey ? (_internsMapKeys ? kPINMaxInternedKeyLength : 0) : _maximumInternedValueLength);
+  if (internLimit > 0 && len <= internLimit) {
+    if (_stringTable == NULL) {
+      _stringTable = PINStringTableCreate(kPINMaxInternedStringCount);
+    }
+    CFStringRef interned = PINStringTableGet(_stringTable, bytes, len);
+    if (interned) {
+      return (__bridge_transfer NSString *)CFRetain(interned);
+    }
+    CFStringRef str = PINStringCreateWithUTF8Bytes(bytes, len);
+    if (str) {
+      PINStringTableAdd(_stringTable, bytes, len, str);
+    }
+    return (__bridge_transfer NSString *)str;
+  }
+  return (__bridge_transfer NSString *)PINStringCreateWithUTF8Bytes(bytes, len);
+}
+
+/// Scratch space for `count` object references, or NULL if the count is unreasonable.
+- (CFTypeRef *)_scratchObjectsWithCount:(NSUInteger)count
+{
+  // When we have the whole message, every element takes at least one byte.
+  if (_buffer == nil && count > PINByteCursorRemaining(&_cursor)) {
+    return NULL;
+  }
+  if (count > SIZE_MAX / sizeof(CFTypeRef)) {
+    return NULL;
+  }
+  return PINScratchAlloc(&_scratch, count * sizeof(CFTypeRef));
+}
+
 - (NSInteger)decodeInteger
 {
   if (sizeof(NSInteger) == sizeof(int64_t)) {
@@ -95,12 +460,50 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
   }
 }
 
+- (void)enumerateMessagesOfClass:(Class)class usingBlock:(void (^)(id, BOOL *))block
+{
+  BOOL stop = NO;
+  while (!stop && ![self _isAtEnd]) {
+    @autoreleasepool {
+      PINUnpackerBeginMessage(self);
+      id message = [self _decodeObjectOfClass:class allowNull:NO isKey:NO];
+      PINUnpackerEndMessage(self);
+      if (_cmpContext.error) {
+        return;
+      }
+      block(message, &stop);
+    }
+  }
+}
+
+/// Whether we're at the end of the input, waiting for more if needed.
+- (BOOL)_isAtEnd
+{
+  if (_buffer) {
+    return [_buffer isAtEnd];
+  }
+  return (PINByteCursorRemaining(&_cursor) == 0);
+}
+
+/// Used by PINMessagePushUnpacker to point us at each message it frames.
+- (void)_resetWithData:(NSData *)data length:(NSUInteger)length offset:(NSUInteger)offset
+{
+  NSParameterAssert(_buffer == nil && offset <= length && length <= data.length);
+  _data = data;
+  _cursor = PINByteCursorMake(data.bytes, length);
+  _cursor.offset = offset;
+  _pendingMapCount = 0;
+}
+
 - (id)decodeObjectOfClass:(Class)class NS_RETURNS_RETAINED
 {
-  return [self _decodeObjectOfClass:class allowNull:NO];
+  PINUnpackerBeginMessage(self);
+  id result = [self _decodeObjectOfClass:class allowNull:NO isKey:NO];
+  PINUnpackerEndMessage(self);
+  return result;
 }
 
-- (id)_decodeObjectOfClass:(Class)class allowNull:(BOOL)allowNull NS_RETURNS_RETAINED
+- (id)_decodeObjectOfClass:(Class)class allowNull:(BOOL)allowNull isKey:(BOOL)isKey NS_RETURNS_RETAINED
 {
   static Class numberClass;
   static Class stringClass;
@@ -108,6 +511,7 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
   static Class arrayClass;
   static Class dictionaryClass;
   static Class setClass;
+  static Class dateClass;
   static dispatch_once_t onceToken;
   dispatch_once(&onceToken, ^{
     numberClass = [NSNumber class];
@@ -116,20 +520,30 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
     arrayClass = [NSArray class];
     dictionaryClass = [NSDictionary class];
     setClass = [NSSet class];
+    dateClass = [NSDate class];
   });
   
   // If we have a custom class, immediately give them control and don't
   // pull any data from the stream.
-  if (class && class != numberClass && class != stringClass && class != dataClass && class != arrayClass && class != dictionaryClass && class != setClass) {
+  if (class && class != numberClass && class != stringClass && class != dataClass && class != arrayClass && class != dictionaryClass && class != setClass && class != dateClass) {
     id<PINStreamingDecoding> inst = [class alloc];
     // Currently no production check on this. If they pass an invalid
     // class, they'll get hit with an easily-understandable
     // doesNotRespondToSelector: exception.
-    return [inst initWithStreamingDecoder:self];
+    _depth++;
+    id result = [inst initWithStreamingDecoder:self];
+    _depth--;
+    return result;
   }
   
   cmp_object_t o;
-  cmp_read_object(&_cmpContext, &o);
+  if (!cmp_read_object(&_cmpContext, &o)) {
+    [self failWithErrorCode:NSNotFound];
+    return nil;
+  }
+  if (_collectsStatistics) {
+    PINUnpackerRecordObject(self, o.type);
+  }
   switch (o.type) {
     case CMP_TYPE_NIL:
       return (allowNull ? (__bridge_transfer NSNull *)kCFNull : nil);
@@ -139,28 +553,53 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
     case CMP_TYPE_FIXSTR: {
       ENSURE_CLASS(class, stringClass);
       
-      // Copy the bytes onto the stack and then into the string.
-      // It's possible to use malloc here and CreateWithBytesNoCopy, to get
-      // the bytes straight into the string. But for short strings,
-      // you will get a tagged pointer or an inline string and you save
-      // a malloc/free pair.
+      // Usually the bytes are contiguous in the input, and go straight
+      // into the string. For short strings you will get a tagged pointer
+      // or an inline string, so this beats CreateWithBytesNoCopy.
       const uint32_t len = o.as.str_size;
-      const uint32_t bufSize = len + 1;
-      char buf[bufSize];
-      if (!cmp_object_to_str(&_cmpContext, &o, buf, bufSize)) {
-        [self failWithErrorCode:NSNotFound];
-        return nil;
+      const char *bytes = [self _peekBytes:len];
+      if (bytes) {
+        NSString *result = [self _stringWithBytes:bytes length:len isKey:isKey];
+        [self _consumeBytes:len];
+        return result;
+      }
+      
+      // Otherwise copy the bytes onto the stack and then into the string.
+      char stackBuf[kPINStackStringLength];
+      PINScratchMark mark = PINScratchGetMark(&_scratch);
+      char *buf = (len <= kPINStackStringLength ? stackBuf : PINScratchAlloc(&_scratch, len));
+      NSString *result = nil;
+      if (buf == NULL) {
+        [self failWithErrorCode:PINMessagePackErrorStringDataTooLong];
+      } else if ([self _readBytes:buf length:len]) {
+        result = [self _stringWithBytes:buf length:len isKey:isKey];
       }
-      return (__bridge_transfer NSString *)CFStringCreateWithBytes(NULL, (UInt8 *)buf, len, kCFStringEncodingUTF8, false);
+      PINScratchReset(&_scratch, mark);
+      return result;
     }
     case CMP_TYPE_BIN8:
     case CMP_TYPE_BIN16:
     case CMP_TYPE_BIN32: {
       ENSURE_CLASS(class, dataClass);
       const uint32_t size = o.as.bin_size;
+      if (_decodesBinaryDataWithoutCopying && (_buffer || _data)) {
+        return [self _readDataViewOfLength:size];
+      }
+      
+      const UInt8 *bytes = [self _peekBytes:size];
+      if (bytes) {
+        NSData *result = (__bridge_transfer NSData *)CFDataCreate(NULL, bytes, size);
+        [self _consumeBytes:size];
+        return result;
+      }
+      
+      // Straddles chunks, so gather it.
       UInt8 *data = malloc(size);
-      if (!cmp_object_to_bin(&_cmpContext, &o, data, size)) {
-        [self failWithErrorCode:NSNotFound];
+      if (data == NULL) {
+        [self failWithErrorCode:PINMessagePackErrorBinaryDataTooLong];
+        return nil;
+      }
+      if (![self _readBytes:data length:size]) {
         free(data);
         return nil;
       }
@@ -193,7 +632,7 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
       }
     case CMP_TYPE_DOUBLE:
       if (class == stringClass) {
-        return (__bridge_transfer NSString *)CFStringCreateWithFormat(NULL, NULL, CFSTR("%f"), o.as.dbl);
+        return (__bridge_transfer NSString *)PINStringCreateWithDouble(o.as.dbl);
       } else if (class == Nil || class == numberClass) {
         return (__bridge_transfer NSNumber *)CFNumberCreate(NULL, kCFNumberDoubleType, &o.as.dbl);
       } else {
@@ -202,7 +641,7 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
       }
     case CMP_TYPE_FLOAT:
       if (class == stringClass) {
-        return (__bridge_transfer NSString *)CFStringCreateWithFormat(NULL, NULL, CFSTR("%f"), o.as.flt);
+        return (__bridge_transfer NSString *)PINStringCreateWithFloat(o.as.flt);
       } else if (class == Nil || class == numberClass) {
         return (__bridge_transfer NSNumber *)CFNumberCreate(NULL, kCFNumberFloatType, &o.as.flt);
       } else {
@@ -213,9 +652,9 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
     case CMP_TYPE_NEGATIVE_FIXNUM:
     case CMP_TYPE_SINT8:
       if (class == stringClass) {
-        return (__bridge_transfer NSString *)CFStringCreateWithFormat(NULL, NULL, CFSTR("%"PRId8), o.as.s8);
+        return (__bridge_transfer NSString *)PINStringCreateWithInt64(o.as.s8);
       } else if (class == Nil || class == numberClass) {
-        return (__bridge_transfer NSNumber *)CFNumberCreate(NULL, kCFNumberSInt8Type, &o.as.s8);
+        return (__bridge_transfer NSNumber *)PINNumberCreateWithInteger(o.as.s8, kCFNumberSInt8Type, &o.as.s8);
       } else {
         [self failWithErrorCode:PINMessagePackErrorInvalidType];
         return nil;
@@ -223,27 +662,27 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
       
     case CMP_TYPE_SINT16:
       if (class == stringClass) {
-        return (__bridge_transfer NSString *)CFStringCreateWithFormat(NULL, NULL, CFSTR("%"PRId16), o.as.s16);
+        return (__bridge_transfer NSString *)PINStringCreateWithInt64(o.as.s16);
       } else if (class == Nil || class == numberClass) {
-        return (__bridge_transfer NSNumber *)CFNumberCreate(NULL, kCFNumberSInt16Type, &o.as.s16);
+        return (__bridge_transfer NSNumber *)PINNumberCreateWithInteger(o.as.s16, kCFNumberSInt16Type, &o.as.s16);
       } else {
         [self failWithErrorCode:PINMessagePackErrorInvalidType];
         return nil;
       }
     case CMP_TYPE_SINT32:
       if (class == stringClass) {
-        return (__bridge_transfer NSString *)CFStringCreateWithFormat(NULL, NULL, CFSTR("%"PRId32), o.as.s32);
+        return (__bridge_transfer NSString *)PINStringCreateWithInt64(o.as.s32);
       } else if (class == Nil || class == numberClass) {
-        return (__bridge_transfer NSNumber *)CFNumberCreate(NULL, kCFNumberSInt32Type, &o.as.s32);
+        return (__bridge_transfer NSNumber *)PINNumberCreateWithInteger(o.as.s32, kCFNumberSInt32Type, &o.as.s32);
       } else {
         [self failWithErrorCode:PINMessagePackErrorInvalidType];
         return nil;
       }
     case CMP_TYPE_SINT64:
       if (class == stringClass) {
-        return (__bridge_transfer NSString *)CFStringCreateWithFormat(NULL, NULL, CFSTR("%"PRId64), o.as.s64);
+        return (__bridge_transfer NSString *)PINStringCreateWithInt64(o.as.s64);
       } else if (class == Nil || class == numberClass) {
-        return (__bridge_transfer NSNumber *)CFNumberCreate(NULL, kCFNumberSInt64Type, &o.as.s64);
+        return (__bridge_transfer NSNumber *)PINNumberCreateWithInteger(o.as.s64, kCFNumberSInt64Type, &o.as.s64);
       } else {
         [self failWithErrorCode:PINMessagePackErrorInvalidType];
         return nil;
@@ -253,37 +692,37 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
       // we mimic NSNumber and store them in the next-largest signed type. U64
       // is handled specially.
       if (class == stringClass) {
-        return (__bridge_transfer NSString *)CFStringCreateWithFormat(NULL, NULL, CFSTR("%"PRIu8), o.as.u8);
+        return (__bridge_transfer NSString *)PINStringCreateWithUInt64(o.as.u8);
       } else if (class == Nil || class == numberClass) {
         SInt16 val = (SInt16)o.as.u8;
-        return (__bridge_transfer NSNumber *)CFNumberCreate(NULL, kCFNumberSInt16Type, &val);
+        return (__bridge_transfer NSNumber *)PINNumberCreateWithInteger(val, kCFNumberSInt16Type, &val);
       } else {
         [self failWithErrorCode:PINMessagePackErrorInvalidType];
         return nil;
       }
     case CMP_TYPE_UINT16:
       if (class == stringClass) {
-        return (__bridge_transfer NSString *)CFStringCreateWithFormat(NULL, NULL, CFSTR("%"PRIu16), o.as.u16);
+        return (__bridge_transfer NSString *)PINStringCreateWithUInt64(o.as.u16);
       } else if (class == Nil || class == numberClass) {
         SInt32 val = (SInt32)o.as.u16;
-        return (__bridge_transfer NSNumber *)CFNumberCreate(NULL, kCFNumberSInt32Type, &val);
+        return (__bridge_transfer NSNumber *)PINNumberCreateWithInteger(val, kCFNumberSInt32Type, &val);
       } else {
         [self failWithErrorCode:PINMessagePackErrorInvalidType];
         return nil;
       }
     case CMP_TYPE_UINT32:
       if (class == stringClass) {
-        return (__bridge_transfer NSString *)CFStringCreateWithFormat(NULL, NULL, CFSTR("%"PRIu32), o.as.u32);
+        return (__bridge_transfer NSString *)PINStringCreateWithUInt64(o.as.u32);
       } else if (class == Nil || class == numberClass) {
         SInt64 val = (SInt64)o.as.u32;
-        return (__bridge_transfer NSNumber *)CFNumberCreate(NULL, kCFNumberSInt64Type, &val);
+        return (__bridge_transfer NSNumber *)PINNumberCreateWithInteger(val, kCFNumberSInt64Type, &val);
       } else {
         [self failWithErrorCode:PINMessagePackErrorInvalidType];
         return nil;
       }
     case CMP_TYPE_UINT64:
       if (class == stringClass) {
-        return (__bridge_transfer NSString *)CFStringCreateWithFormat(NULL, NULL, CFSTR("%"PRIu64), o.as.u64);
+        return (__bridge_transfer NSString *)PINStringCreateWithUInt64(o.as.u64);
       } else if (class == Nil || class == numberClass) {
         // NSNumber uses the private kCFNumberSInt128Type (17).
         return [[NSNumber alloc] initWithUnsignedLongLong:o.as.u64];
@@ -291,6 +730,21 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
         [self failWithErrorCode:PINMessagePackErrorInvalidType];
         return nil;
       }
+    case CMP_TYPE_FIXEXT1:
+    case CMP_TYPE_FIXEXT2:
+    case CMP_TYPE_FIXEXT4:
+    case CMP_TYPE_FIXEXT8:
+    case CMP_TYPE_FIXEXT16:
+    case CMP_TYPE_EXT8:
+    case CMP_TYPE_EXT16:
+    case CMP_TYPE_EXT32: {
+      id result = [self _decodeExtensionOfType:o.as.ext.type size:o.as.ext.size];
+      if (result && class && ![result isKindOfClass:class]) {
+        [self failWithErrorCode:PINMessagePackErrorInvalidType];
+        return nil;
+      }
+      return result;
+    }
     default:
       [self failWithErrorCode:PINMessagePackInternalError];
       return nil;
@@ -299,111 +753,172 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
 
 - (NSArray *)decodeArrayOfClass:(Class)class NS_RETURNS_RETAINED
 {
+  PINUnpackerBeginMessage(self);
+  NSArray *result = nil;
   uint32_t count;
   if (!cmp_read_array(&_cmpContext, &count)) {
     [self failWithErrorCode:NSNotFound];
-    return nil;
+  } else {
+    if (_collectsStatistics) {
+      PINUnpackerRecordObject(self, CMP_TYPE_ARRAY32);
+    }
+    result = [self _decodeArrayOrSet:NO count:count class:class];
   }
-  return [self _decodeArrayOrSet:NO count:count class:class];
+  PINUnpackerEndMessage(self);
+  return result;
 }
 
 - (NSSet *)decodeSetOfClass:(Class)class NS_RETURNS_RETAINED
 {
+  PINUnpackerBeginMessage(self);
+  NSSet *result = nil;
   uint32_t count;
   if (!cmp_read_array(&_cmpContext, &count)) {
     [self failWithErrorCode:NSNotFound];
-    return nil;
+  } else {
+    if (_collectsStatistics) {
+      PINUnpackerRecordObject(self, CMP_TYPE_ARRAY32);
+    }
+    result = [self _decodeArrayOrSet:YES count:count class:class];
   }
-  return [self _decodeArrayOrSet:YES count:count class:class];
+  PINUnpackerEndMessage(self);
+  return result;
 }
 
 - (id)_decodeArrayOrSet:(BOOL)isSet count:(NSUInteger)count class:(Class)class NS_RETURNS_RETAINED
 {
-  CFTypeRef vals[count];
-  for (NSUInteger i = 0; i < count; i++) {
-    if (!(vals[i] = (__bridge_retained CFTypeRef)[self _decodeObjectOfClass:class allowNull:YES])) {
-      // In case of an error, we don't want to leak these so we need to release them.
-      for (NSUInteger j = 0; j < i; j++) {
-        CFRelease(vals[j]);
-      }
-      return nil;
+  PINUnpackerRecordContainer(self, count);
+  if (!isSet && class == Nil && count > 0 && [self _canDecodeLazily]) {
+    return [self _decodeLazyArrayWithCount:count];
+  }
+  if (!isSet && class == Nil && count >= kPINConcurrentArrayMinimumCount && _decodingConcurrency > 1 && _buffer == nil) {
+    id result = [self _decodeArrayConcurrentlyWithCount:count];
+    if (result || _cmpContext.error) {
+      return result;
+    }
+    // Too small to be worth it. We're back at the first element, so decode serially.
+  }
+  
+  CFTypeRef stackVals[kPINStackCollectionCount];
+  PINScratchMark mark = PINScratchGetMark(&_scratch);
+  CFTypeRef *vals = (count <= kPINStackCollectionCount ? stackVals : [self _scratchObjectsWithCount:count]);
+  if (vals == NULL) {
+    [self failWithErrorCode:PINMessagePackErrorArrayTooLong];
+    return nil;
+  }
+  
+  NSUInteger i = 0;
+  _depth++;
+  for (; i < count; i++) {
+    if (!(vals[i] = (__bridge_retained CFTypeRef)[self _decodeObjectOfClass:class allowNull:YES isKey:NO])) {
+      break;
     }
   }
-  if (isSet) {
-    return [NSSet pin_setWithRetainedObjects:vals count:count];
+  _depth--;
+  
+  id result = nil;
+  if (i == count) {
+    if (isSet) {
+      result = [NSSet pin_setWithRetainedObjects:vals count:count];
+    } else {
+      result = [NSArray pin_arrayWithRetainedObjects:vals count:count];
+    }
   } else {
-    return [NSArray pin_arrayWithRetainedObjects:vals count:count];
+    // In case of an error, we don't want to leak these so we need to release them.
+    for (NSUInteger j = 0; j < i; j++) {
+      CFRelease(vals[j]);
+    }
   }
+  PINScratchReset(&_scratch, mark);
+  return result;
 }
 
 - (NSDictionary *)decodeDictionaryWithKeyClass:(Class)keyClass objectClass:(Class)objectClass NS_RETURNS_RETAINED
 {
+  PINUnpackerBeginMessage(self);
+  NSDictionary *result = nil;
   uint32_t count;
   if (!cmp_read_map(&_cmpContext, &count)) {
     [self failWithErrorCode:NSNotFound];
-    return nil;
+  } else {
+    if (_collectsStatistics) {
+      PINUnpackerRecordObject(self, CMP_TYPE_MAP32);
+    }
+    result = [self _decodeDictionaryWithCount:count keyClass:keyClass objectClass:objectClass];
   }
-  
-  return [self _decodeDictionaryWithCount:count keyClass:keyClass objectClass:objectClass];
+  PINUnpackerEndMessage(self);
+  return result;
 }
 
 - (NSDictionary *)_decodeDictionaryWithCount:(NSUInteger)count keyClass:(Class)keyClass objectClass:(Class)objectClass NS_RETURNS_RETAINED
 {
-  CFTypeRef keys[count];
-  CFTypeRef vals[count];
+  PINUnpackerRecordContainer(self, count);
+  if (objectClass == Nil && count > 0 && [self _canDecodeLazily]) {
+    return [self _decodeLazyDictionaryWithCount:count keyClass:keyClass];
+  }
+  
+  CFTypeRef stackKeys[kPINStackCollectionCount];
+  CFTypeRef stackVals[kPINStackCollectionCount];
+  PINScratchMark mark = PINScratchGetMark(&_scratch);
+  CFTypeRef *keys = stackKeys;
+  CFTypeRef *vals = stackVals;
+  if (count > kPINStackCollectionCount) {
+    keys = [self _scratchObjectsWithCount:count];
+    vals = [self _scratchObjectsWithCount:count];
+    if (keys == NULL || vals == NULL) {
+      PINScratchReset(&_scratch, mark);
+      [self failWithErrorCode:PINMessagePackErrorMapTooLong];
+      return nil;
+    }
+  }
   if (keyClass == Nil && self.forcesMapKeysToString) {
     keyClass = [NSString class];
   }
-  for (NSUInteger i = 0; i < count; i++) {
-    
+  
+  NSUInteger i = 0;
+  _depth++;
+  for (; i < count; i++) {
     // Read key
-    if (!(keys[i] = (__bridge_retained CFTypeRef)[self _decodeObjectOfClass:keyClass allowNull:YES])) {
-      for (NSUInteger j = 0; j < i; j++) {
-        CFRelease(keys[j]);
-        CFRelease(vals[j]);
-      }
-      return nil;
+    if (!(keys[i] = (__bridge_retained CFTypeRef)[self _decodeObjectOfClass:keyClass allowNull:YES isKey:YES])) {
+      break;
     }
     
     // Read val
-    if (!(vals[i] = (__bridge_retained CFTypeRef)[self _decodeObjectOfClass:objectClass allowNull:YES])) {
-      for (NSUInteger j = 0; j < i; j++) {
-        CFRelease(keys[j]);
-        CFRelease(vals[j]);
-      }
+    if (!(vals[i] = (__bridge_retained CFTypeRef)[self _decodeObjectOfClass:objectClass allowNull:YES isKey:NO])) {
       CFRelease(keys[i]);
-      return nil;
+      break;
+    }
+  }
+  _depth--;
+  
+  NSDictionary *result = nil;
+  if (i == count) {
+    result = [NSDictionary pin_dictionaryWithRetainedObjects:vals keys:keys count:count];
+  } else {
+    for (NSUInteger j = 0; j < i; j++) {
+      CFRelease(keys[j]);
+      CFRelease(vals[j]);
     }
   }
-  return [NSDictionary pin_dictionaryWithRetainedObjects:vals keys:keys count:count];
+  PINScratchReset(&_scratch, mark);
+  return result;
 }
 
 - (double)decodeDouble
 {
-  cmp_object_t o;
-  if (!cmp_read_object(&_cmpContext, &o)) {
+  return [self _decodeDoublePresent:NULL];
+}
+
+- (void)skipValue
+{
+  if (!cmp_skip_object_no_limit(&_cmpContext)) {
     [self failWithErrorCode:NSNotFound];
-    return 0;
-  }
-  switch (o.type) {
-    case CMP_TYPE_DOUBLE:
-      return o.as.dbl;
-    case CMP_TYPE_FLOAT:
-      return (double)o.as.flt;
-    default:
-      [self failWithErrorCode:PINMessagePackErrorInvalidType];
-      return 0;
   }
 }
 
 - (BOOL)decodeBOOL
 {
-  bool b;
-  if (!cmp_read_bool(&_cmpContext, &b)) {
-    [self failWithErrorCode:NSNotFound];
-    return NO;
-  }
-  return (BOOL)b;
+  return [self _decodeBOOLPresent:NULL];
 }
 
 - (void)enumerateKeysInMapWithBlock:(nonnull void (^)(const char * _Nonnull, NSUInteger))block {
@@ -420,19 +935,30 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
     // Can't use cmp_read_str because we want to read
     // into a stack buf and need to get size THEN contents.
     cmp_object_t o;
-    cmp_read_object(&_cmpContext, &o);
+    if (!cmp_read_object(&_cmpContext, &o)) {
+      [self failWithErrorCode:NSNotFound];
+      return;
+    }
     switch (o.type) {
       case CMP_TYPE_STR8:
       case CMP_TYPE_STR16:
       case CMP_TYPE_STR32:
       case CMP_TYPE_FIXSTR: {
         uint32_t len = o.as.str_size;
-        char key[len+1];
-        if (!cmp_object_to_str(&_cmpContext, &o, key, len+1)) {
-          [self failWithErrorCode:NSNotFound];
+        char stackKey[kPINStackStringLength];
+        PINScratchMark mark = PINScratchGetMark(&_scratch);
+        char *key = (len < kPINStackStringLength ? stackKey : PINScratchAlloc(&_scratch, (size_t)len + 1));
+        if (key == NULL) {
+          [self failWithErrorCode:PINMessagePackErrorStringDataTooLong];
           return;
         }
+        if (![self _readBytes:key length:len]) {
+          PINScratchReset(&_scratch, mark);
+          return;
+        }
+        key[len] = '\0';
         block(key, len);
+        PINScratchReset(&_scratch, mark);
         break;
       }
       default:
@@ -442,4 +968,1115 @@ static bool stream_reader(cmp_ctx_t *ctx, void *data, size_t limit) {
   }
 }
 
+#pragma mark - Primitives
+
+- (int32_t)decodeInt32
+{
+  const int64_t v = [self _decodeInt64Present:NULL];
+  if (v < INT32_MIN || v > INT32_MAX) {
+    [self failWithErrorCode:PINMessagePackErrorInvalidType];
+    return 0;
+  }
+  return (int32_t)v;
+}
+
+- (uint32_t)decodeUInt32
+{
+  const uint64_t v = [self _decodeUInt64Present:NULL];
+  if (v > UINT32_MAX) {
+    [self failWithErrorCode:PINMessagePackErrorInvalidType];
+    return 0;
+  }
+  return (uint32_t)v;
+}
+
+- (int64_t)decodeInt64
+{
+  return [self _decodeInt64Present:NULL];
+}
+
+- (uint64_t)decodeUInt64
+{
+  return [self _decodeUInt64Present:NULL];
+}
+
+- (float)decodeFloat
+{
+  return [self _decodeFloatPresent:NULL];
+}
+
+- (int64_t)decodeOptionalInt64:(BOOL *)present
+{
+  return [self _decodeInt64Present:present];
+}
+
+- (uint64_t)decodeOptionalUInt64:(BOOL *)present
+{
+  return [self _decodeUInt64Present:present];
+}
+
+- (double)decodeOptionalDouble:(BOOL *)present
+{
+  return [self _decodeDoublePresent:present];
+}
+
+- (float)decodeOptionalFloat:(BOOL *)present
+{
+  return [self _decodeFloatPresent:present];
+}
+
+- (BOOL)decodeOptionalBOOL:(BOOL *)present
+{
+  return [self _decodeBOOLPresent:present];
+}
+
+/// Reads the next value for one of the primitive decoders. If `present` is
+/// given, nil is allowed and reported through it. Returns NO if there's
+/// no value to convert.
+- (BOOL)_readPrimitive:(cmp_object_t *)o present:(BOOL *)present
+{
+  if (present) {
+    *present = NO;
+  }
+  if (!cmp_read_object(&_cmpContext, o)) {
+    [self failWithErrorCode:NSNotFound];
+    return NO;
+  }
+  if (o->type == CMP_TYPE_NIL) {
+    if (present == NULL) {
+      [self failWithErrorCode:PINMessagePackErrorInvalidType];
+    }
+    return NO;
+  }
+  return YES;
+}
+
+- (int64_t)_decodeInt64Present:(BOOL *)present
+{
+  cmp_object_t o;
+  if (![self _readPrimitive:&o present:present]) {
+    return 0;
+  }
+  int64_t v;
+  if (!cmp_object_as_long(&o, &v)) {
+    [self failWithErrorCode:PINMessagePackErrorInvalidType];
+    return 0;
+  }
+  if (present) {
+    *present = YES;
+  }
+  return v;
+}
+
+- (uint64_t)_decodeUInt64Present:(BOOL *)present
+{
+  cmp_object_t o;
+  if (![self _readPrimitive:&o present:present]) {
+    return 0;
+  }
+  // Like cmp_read_uint, accept signed encodings of non-negative values.
+  uint64_t v;
+  if (!cmp_object_as_ulong(&o, &v)) {
+    int64_t s;
+    if (!cmp_object_as_long(&o, &s) || s < 0) {
+      [self failWithErrorCode:PINMessagePackErrorInvalidType];
+      return 0;
+    }
+    v = (uint64_t)s;
+  }
+  if (present) {
+    *present = YES;
+  }
+  return v;
+}
+
+- (double)_decodeDoublePresent:(BOOL *)present
+{
+  cmp_object_t o;
+  if (![self _readPrimitive:&o present:present]) {
+    return 0;
+  }
+  double v;
+  switch (o.type) {
+    case CMP_TYPE_DOUBLE:
+      v = o.as.dbl;
+      break;
+    case CMP_TYPE_FLOAT:
+      v = (double)o.as.flt;
+      break;
+    default:
+      [self failWithErrorCode:PINMessagePackErrorInvalidType];
+      return 0;
+  }
+  if (present) {
+    *present = YES;
+  }
+  return v;
+}
+
+- (float)_decodeFloatPresent:(BOOL *)present
+{
+  // Doubles are narrowed, since many encoders only write float64.
+  return (float)[self _decodeDoublePresent:present];
+}
+
+- (BOOL)_decodeBOOLPresent:(BOOL *)present
+{
+  cmp_object_t o;
+  if (![self _readPrimitive:&o present:present]) {
+    return NO;
+  }
+  if (o.type != CMP_TYPE_BOOLEAN) {
+    [self failWithErrorCode:PINMessagePackErrorInvalidType];
+    return NO;
+  }
+  if (present) {
+    *present = YES;
+  }
+  return (BOOL)o.as.boolean;
+}
+
+#pragma mark - Extensions
+
+- (void)registerExtensionType:(int8_t)type handler:(PINExtensionHandler)handler
+{
+  NSMutableDictionary *handlers = [_extensionHandlers mutableCopy] ?: [[NSMutableDictionary alloc] init];
+  handlers[@(type)] = [handler copy];
+  _extensionHandlers = [handlers copy];
+}
+
+- (void)registerExtensionType:(int8_t)type class:(Class<PINExtensionDecoding>)class
+{
+  [self registerExtensionType:type handler:^id(int8_t type, const void *bytes, NSUInteger length) {
+    return [[(Class)class alloc] initWithExtensionBytes:bytes length:length];
+  }];
+}
+
+/// Decodes the payload of an extension value whose header was already read.
+- (id)_decodeExtensionOfType:(int8_t)type size:(uint32_t)size NS_RETURNS_RETAINED
+{
+  PINExtensionHandler handler = (_extensionHandlers ? _extensionHandlers[@(type)] : nil);
+  if (handler == nil && type == kPINTimestampExtensionType) {
+    return [self _decodeTimestampWithSize:size];
+  }
+  if (handler == nil) {
+    [self failWithErrorCode:PINMessagePackErrorInvalidType];
+    return nil;
+  }
+  
+  BOOL inPlace;
+  PINScratchMark mark;
+  const char *bytes = [self _beginReadingBytes:size inPlace:&inPlace mark:&mark];
+  if (bytes == NULL) {
+    return nil;
+  }
+  id result = handler(type, bytes, size);
+  [self _endReadingBytes:size inPlace:inPlace mark:mark];
+  if (result == nil) {
+    [self failWithErrorCode:PINMessagePackErrorInvalidType];
+  }
+  return result;
+}
+
+/// Timestamps are at most 12 bytes, so they go straight from the stack into a CFDate.
+- (NSDate *)_decodeTimestampWithSize:(uint32_t)size NS_RETURNS_RETAINED
+{
+  uint8_t bytes[12];
+  if (size > sizeof(bytes)) {
+    [self failWithErrorCode:PINMessagePackErrorInvalidType];
+    return nil;
+  }
+  if (![self _readBytes:bytes length:size]) {
+    return nil;
+  }
+  int64_t seconds;
+  uint32_t nanoseconds;
+  if (!PINTimestampDecode(bytes, size, &seconds, &nanoseconds)) {
+    [self failWithErrorCode:PINMessagePackErrorInvalidType];
+    return nil;
+  }
+  return (__bridge_transfer NSDate *)CFDateCreate(NULL, PINTimestampGetAbsoluteTime(seconds, nanoseconds));
+}
+
+#pragma mark - Numeric Arrays
+
+- (NSUInteger)decodeInt64Array:(int64_t *)values maxCount:(NSUInteger)maxCount
+{
+  return [self _decodeNumericArrayOfType:PINNumericTypeInt64 values:values maxCount:maxCount];
+}
+
+- (NSUInteger)decodeDoubleArray:(double *)values maxCount:(NSUInteger)maxCount
+{
+  return [self _decodeNumericArrayOfType:PINNumericTypeDouble values:values maxCount:maxCount];
+}
+
+- (NSUInteger)decodeFloatArray:(float *)values maxCount:(NSUInteger)maxCount
+{
+  return [self _decodeNumericArrayOfType:PINNumericTypeFloat values:values maxCount:maxCount];
+}
+
+- (NSData *)decodeInt64Array NS_RETURNS_RETAINED
+{
+  return [self _decodeNumericArrayDataOfType:PINNumericTypeInt64];
+}
+
+- (NSData *)decodeDoubleArray NS_RETURNS_RETAINED
+{
+  return [self _decodeNumericArrayDataOfType:PINNumericTypeDouble];
+}
+
+- (NSData *)decodeFloatArray NS_RETURNS_RETAINED
+{
+  return [self _decodeNumericArrayDataOfType:PINNumericTypeFloat];
+}
+
+- (NSUInteger)_decodeNumericArrayOfType:(PINNumericType)type values:(void *)values maxCount:(NSUInteger)maxCount
+{
+  uint32_t count;
+  if (!cmp_read_array(&_cmpContext, &count)) {
+    [self failWithErrorCode:NSNotFound];
+    return 0;
+  }
+  if (count > maxCount) {
+    [self failWithErrorCode:PINMessagePackErrorArrayTooLong];
+    return 0;
+  }
+  return ([self _decodeNumbersOfType:type values:values count:count] ? count : 0);
+}
+
+- (NSData *)_decodeNumericArrayDataOfType:(PINNumericType)type NS_RETURNS_RETAINED
+{
+  uint32_t count;
+  if (!cmp_read_array(&_cmpContext, &count)) {
+    [self failWithErrorCode:NSNotFound];
+    return nil;
+  }
+  
+  // When we have the whole message, every element takes at least one byte.
+  const size_t size = PINNumericTypeSize(type);
+  void *values = NULL;
+  if (_buffer != nil || count <= PINByteCursorRemaining(&_cursor)) {
+    values = malloc(MAX((size_t)count * size, 1));
+  }
+  if (values == NULL) {
+    [self failWithErrorCode:PINMessagePackErrorArrayTooLong];
+    return nil;
+  }
+  if (![self _decodeNumbersOfType:type values:values count:count]) {
+    free(values);
+    return nil;
+  }
+  return [[NSData alloc] initWithBytesNoCopy:values length:(size_t)count * size freeWhenDone:YES];
+}
+
+/// Decodes `count` numbers, in uniform runs straight from the input where possible.
+- (BOOL)_decodeNumbersOfType:(PINNumericType)type values:(void *)values count:(NSUInteger)count
+{
+  const size_t size = PINNumericTypeSize(type);
+  NSUInteger i = 0;
+  while (i < count) {
+    NSUInteger available;
+    const uint8_t *bytes = [self _peekAvailableBytes:&available];
+    if (bytes) {
+      size_t consumed;
+      i += PINNumericArrayDecodeRun(bytes, available, type, (uint8_t *)values + i * size, count - i, &consumed);
+      [self _consumeBytes:consumed];
+      if (i == count) {
+        break;
+      }
+    }
+    
+    // Decode one element through cmp, e.g. where the encoding changes or at a chunk boundary.
+    cmp_object_t o;
+    if (!cmp_read_object(&_cmpContext, &o)) {
+      [self failWithErrorCode:NSNotFound];
+      return NO;
+    }
+    if (!PINNumericArrayStoreObject(&o, type, values, i)) {
+      [self failWithErrorCode:PINMessagePackErrorInvalidType];
+      return NO;
+    }
+    i++;
+  }
+  return YES;
+}
+
+#pragma mark - Decoding Plans
+
+- (void)decodeMapIntoObject:(id)object withPlan:(PINDecodingPlan *)plan
+{
+  uint32_t count;
+  if (!cmp_read_map(&_cmpContext, &count)) {
+    [self failWithErrorCode:NSNotFound];
+    return;
+  }
+  
+  for (uint32_t i = 0; i < count; i++) {
+    cmp_object_t k;
+    if (!cmp_read_object(&_cmpContext, &k)) {
+      [self failWithErrorCode:NSNotFound];
+      return;
+    }
+    
+    const PINDecodingPlanField *field = NULL;
+    if (k.type == CMP_TYPE_FIXSTR || k.type == CMP_TYPE_STR8 || k.type == CMP_TYPE_STR16 || k.type == CMP_TYPE_STR32) {
+      const uint32_t len = k.as.str_size;
+      BOOL inPlace;
+      PINScratchMark mark;
+      const char *bytes = [self _beginReadingBytes:len inPlace:&inPlace mark:&mark];
+      if (bytes) {
+        field = PINDecodingPlanGetField(plan, bytes, len);
+        [self _endReadingBytes:len inPlace:inPlace mark:mark];
+      }
+    } else {
+      [self _skipPayloadOfObject:&k];
+    }
+    if (_cmpContext.error) {
+      return;
+    }
+    
+    if (field) {
+      [self _decodeField:field intoObject:object];
+    } else if (!cmp_skip_object_no_limit(&_cmpContext)) {
+      [self failWithErrorCode:NSNotFound];
+    }
+    if (_cmpContext.error) {
+      return;
+    }
+  }
+}
+
+/// Whether a signed integer fits in a field of `size` bytes.
+static BOOL PINDecodingFieldFitsSigned(int64_t v, uint8_t size)
+{
+  switch (size) {
+    case 1:
+      return v >= INT8_MIN && v <= INT8_MAX;
+    case 2:
+      return v >= INT16_MIN && v <= INT16_MAX;
+    case 4:
+      return v >= INT32_MIN && v <= INT32_MAX;
+    default:
+      return YES;
+  }
+}
+
+/// Whether an unsigned integer fits in a field of `size` bytes.
+static BOOL PINDecodingFieldFitsUnsigned(uint64_t v, uint8_t size)
+{
+  switch (size) {
+    case 1:
+      return v <= UINT8_MAX;
+    case 2:
+      return v <= UINT16_MAX;
+    case 4:
+      return v <= UINT32_MAX;
+    default:
+      return YES;
+  }
+}
+
+- (void)_decodeField:(const PINDecodingPlanField *)field intoObject:(id)object
+{
+  void *ivar = (uint8_t *)(__bridge void *)object + field->offset;
+  switch (field->kind) {
+    case PINDecodingFieldKindSigned:
+    case PINDecodingFieldKindUnsigned: {
+      cmp_object_t o;
+      if (!cmp_read_object(&_cmpContext, &o)) {
+        [self failWithErrorCode:NSNotFound];
+        return;
+      }
+      // Accept any integer that fits the field, and booleans since BOOL is a char on some platforms.
+      int64_t s;
+      uint64_t u;
+      BOOL fits;
+      if (o.type == CMP_TYPE_BOOLEAN) {
+        u = o.as.boolean;
+        fits = YES;
+      } else if (cmp_object_as_long(&o, &s)) {
+        u = (uint64_t)s;
+        fits = (field->kind == PINDecodingFieldKindSigned ? PINDecodingFieldFitsSigned(s, field->size) : (s >= 0 && PINDecodingFieldFitsUnsigned(u, field->size)));
+      } else if (field->kind == PINDecodingFieldKindUnsigned && o.type == CMP_TYPE_UINT64) {
+        u = o.as.u64;
+        fits = PINDecodingFieldFitsUnsigned(u, field->size);
+      } else {
+        u = 0;
+        fits = NO;
+      }
+      if (!fits) {
+        [self failWithErrorCode:PINMessagePackErrorInvalidType];
+        return;
+      }
+      switch (field->size) {
+        case 1:
+          *(uint8_t *)ivar = (uint8_t)u;
+          break;
+        case 2:
+          *(uint16_t *)ivar = (uint16_t)u;
+          break;
+        case 4:
+          *(uint32_t *)ivar = (uint32_t)u;
+          break;
+        default:
+          *(uint64_t *)ivar = u;
+          break;
+      }
+      break;
+    }
+    case PINDecodingFieldKindBool:
+      *(bool *)ivar = [self decodeBOOL];
+      break;
+    case PINDecodingFieldKindFloat:
+      *(float *)ivar = (float)[self decodeDouble];
+      break;
+    case PINDecodingFieldKindDouble:
+      *(double *)ivar = [self decodeDouble];
+      break;
+    case PINDecodingFieldKindObject:
+      *(__strong id *)ivar = [self _decodeObjectOfClass:field->class allowNull:NO isKey:NO];
+      break;
+  }
+}
+
+#pragma mark - Projection
+
+- (id)decodeObjectOfClass:(Class)class projectingKeyPaths:(NSArray<NSString *> *)keyPaths NS_RETURNS_RETAINED
+{
+  PINKeyPathProjection *projection = [PINKeyPathProjection projectionWithKeyPaths:keyPaths];
+  if (projection == nil) {
+    NSCAssert(NO, @"Invalid key paths: %@", keyPaths);
+    [self skipValue];
+    return nil;
+  }
+  PINUnpackerBeginMessage(self);
+  id result = [self _decodeObjectOfClass:class projection:projection allowNull:NO];
+  PINUnpackerEndMessage(self);
+  return result;
+}
+
+- (id)_decodeObjectOfClass:(Class)class projection:(PINKeyPathProjection *)projection allowNull:(BOOL)allowNull NS_RETURNS_RETAINED
+{
+  if (projection.keepsValue) {
+    return [self _decodeObjectOfClass:class allowNull:allowNull isKey:NO];
+  }
+  
+  cmp_object_t o;
+  if (!cmp_read_object(&_cmpContext, &o)) {
+    [self failWithErrorCode:NSNotFound];
+    return nil;
+  }
+  switch (o.type) {
+    case CMP_TYPE_MAP16:
+    case CMP_TYPE_MAP32:
+    case CMP_TYPE_FIXMAP:
+      ENSURE_CLASS(class, [NSDictionary class]);
+      if (projection.hasChildren) {
+        return [self _decodeDictionaryWithCount:o.as.map_size projection:projection];
+      }
+      break;
+    case CMP_TYPE_ARRAY16:
+    case CMP_TYPE_ARRAY32:
+    case CMP_TYPE_FIXARRAY:
+      ENSURE_CLASS(class, [NSArray class]);
+      if (projection.elementProjection) {
+        return [self _decodeArrayWithCount:o.as.array_size projection:projection.elementProjection];
+      }
+      break;
+    default:
+      break;
+  }
+  
+  // The value doesn't have the shape the paths expect, so skip it.
+  [self _skipPayloadOfObject:&o];
+  return nil;
+}
+
+- (NSDictionary *)_decodeDictionaryWithCount:(NSUInteger)count projection:(PINKeyPathProjection *)projection NS_RETURNS_RETAINED
+{
+  NSMutableDictionary *result = [[NSMutableDictionary alloc] init];
+  for (NSUInteger i = 0; i < count; i++) {
+    cmp_object_t k;
+    if (!cmp_read_object(&_cmpContext, &k)) {
+      [self failWithErrorCode:NSNotFound];
+      return nil;
+    }
+    
+    // Match the key on its bytes, reading them in place if we can.
+    NSString *key = nil;
+    PINKeyPathProjection *child = nil;
+    if (k.type == CMP_TYPE_FIXSTR || k.type == CMP_TYPE_STR8 || k.type == CMP_TYPE_STR16 || k.type == CMP_TYPE_STR32) {
+      const uint32_t len = k.as.str_size;
+      BOOL inPlace;
+      PINScratchMark mark;
+      const char *bytes = [self _beginReadingBytes:len inPlace:&inPlace mark:&mark];
+      if (bytes) {
+        child = [projection childForKeyBytes:bytes length:len key:&key];
+        [self _endReadingBytes:len inPlace:inPlace mark:mark];
+      }
+    } else {
+      [self _skipPayloadOfObject:&k];
+    }
+    if (_cmpContext.error) {
+      return nil;
+    }
+    
+    if (child == nil) {
+      if (!cmp_skip_object_no_limit(&_cmpContext)) {
+        [self failWithErrorCode:NSNotFound];
+        return nil;
+      }
+      continue;
+    }
+    id value = [self _decodeObjectOfClass:Nil projection:child allowNull:YES];
+    if (value) {
+      result[key] = value;
+    } else if (_cmpContext.error) {
+      return nil;
+    }
+  }
+  return [result copy];
+}
+
+- (NSArray *)_decodeArrayWithCount:(NSUInteger)count projection:(PINKeyPathProjection *)projection NS_RETURNS_RETAINED
+{
+  NSMutableArray *result = [[NSMutableArray alloc] init];
+  for (NSUInteger i = 0; i < count; i++) {
+    id value = [self _decodeObjectOfClass:Nil projection:projection allowNull:YES];
+    if (value == nil) {
+      if (_cmpContext.error) {
+        return nil;
+      }
+      value = [NSNull null];
+    }
+    [result addObject:value];
+  }
+  return [result copy];
+}
+
+/// Skips the rest of an object whose header has already been read.
+- (void)_skipPayloadOfObject:(const cmp_object_t *)o
+{
+  size_t byteCount = 0;
+  size_t objectCount = 0;
+  switch (o->type) {
+    case CMP_TYPE_FIXSTR:
+    case CMP_TYPE_STR8:
+    case CMP_TYPE_STR16:
+    case CMP_TYPE_STR32:
+      byteCount = o->as.str_size;
+      break;
+    case CMP_TYPE_BIN8:
+    case CMP_TYPE_BIN16:
+    case CMP_TYPE_BIN32:
+      byteCount = o->as.bin_size;
+      break;
+    case CMP_TYPE_FIXEXT1:
+    case CMP_TYPE_FIXEXT2:
+    case CMP_TYPE_FIXEXT4:
+    case CMP_TYPE_FIXEXT8:
+    case CMP_TYPE_FIXEXT16:
+    case CMP_TYPE_EXT8:
+    case CMP_TYPE_EXT16:
+    case CMP_TYPE_EXT32:
+      byteCount = o->as.ext.size;
+      break;
+    case CMP_TYPE_FIXARRAY:
+    case CMP_TYPE_ARRAY16:
+    case CMP_TYPE_ARRAY32:
+      objectCount = o->as.array_size;
+      break;
+    case CMP_TYPE_FIXMAP:
+    case CMP_TYPE_MAP16:
+    case CMP_TYPE_MAP32:
+      objectCount = (size_t)o->as.map_size * 2;
+      break;
+    default:
+      break;
+  }
+  
+  if (byteCount > 0 && !_cmpContext.skip(&_cmpContext, byteCount)) {
+    [self failWithErrorCode:PINMessagePackErrorReadingData];
+    return;
+  }
+  for (size_t i = 0; i < objectCount; i++) {
+    if (!cmp_skip_object_no_limit(&_cmpContext)) {
+      [self failWithErrorCode:NSNotFound];
+      return;
+    }
+  }
+}
+
+#pragma mark - Mutable Containers
+
+- (BOOL)decodeArrayOfClass:(Class)class intoArray:(NSMutableArray *)array
+{
+  PINUnpackerBeginMessage(self);
+  BOOL success = NO;
+  uint32_t count;
+  if (!cmp_read_array(&_cmpContext, &count)) {
+    [self failWithErrorCode:NSNotFound];
+  } else {
+    if (_collectsStatistics) {
+      PINUnpackerRecordObject(self, CMP_TYPE_ARRAY32);
+    }
+    success = [self _decodeArrayWithCount:count class:class intoArray:array merging:NO];
+  }
+  PINUnpackerEndMessage(self);
+  return success;
+}
+
+- (BOOL)decodeDictionaryWithKeyClass:(Class)keyClass objectClass:(Class)objectClass intoDictionary:(NSMutableDictionary *)dictionary
+{
+  PINUnpackerBeginMessage(self);
+  BOOL success = NO;
+  uint32_t count;
+  if (!cmp_read_map(&_cmpContext, &count)) {
+    [self failWithErrorCode:NSNotFound];
+  } else {
+    if (_collectsStatistics) {
+      PINUnpackerRecordObject(self, CMP_TYPE_MAP32);
+    }
+    success = [self _decodeDictionaryWithCount:count keyClass:keyClass objectClass:objectClass intoDictionary:dictionary merging:NO];
+  }
+  PINUnpackerEndMessage(self);
+  return success;
+}
+
+- (id)decodeObjectMergingIntoObject:(id)object NS_RETURNS_RETAINED
+{
+  PINUnpackerBeginMessage(self);
+  id result = [self _decodeObjectMergingIntoObject:object allowNull:NO];
+  PINUnpackerEndMessage(self);
+  return result;
+}
+
+/**
+ * Whether a merge can update a container in place. CoreFoundation's
+ * immutable arrays and dictionaries, which decoding creates, share their
+ * class with CoreFoundation's mutable ones, so they pass isKindOfClass:
+ * checks for NSMutableArray and NSMutableDictionary. Treat that class as
+ * immutable, and trust the check for any other class.
+ */
+static BOOL PINMergeCanMutate(id object, Class mutableClass)
+{
+  static Class cfArrayClass;
+  static Class cfDictionaryClass;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    const void *values[] = { kCFNull, kCFBooleanTrue };
+    CFArrayRef array = CFArrayCreate(NULL, values, 2, &kCFTypeArrayCallBacks);
+    cfArrayClass = object_getClass((__bridge id)array);
+    CFRelease(array);
+    CFDictionaryRef dictionary = CFDictionaryCreate(NULL, values, values, 2, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+    cfDictionaryClass = object_getClass((__bridge id)dictionary);
+    CFRelease(dictionary);
+  });
+  const Class cls = object_getClass(object);
+  return (cls != cfArrayClass && cls != cfDictionaryClass && [object isKindOfClass:mutableClass]);
+}
+
+- (id)_decodeObjectMergingIntoObject:(id)object allowNull:(BOOL)allowNull NS_RETURNS_RETAINED
+{
+  if ([object conformsToProtocol:@protocol(PINStreamingMerging)]) {
+    _depth++;
+    [(id<PINStreamingMerging>)object mergeWithStreamingDecoder:self];
+    _depth--;
+    return (_cmpContext.error ? nil : object);
+  }
+  
+  // Only maps and arrays merge. Everything else decodes as usual.
+  const uint8_t *marker = [self _peekBytes:1];
+  if (marker == NULL || !PINMarkerIsMapOrArray(*marker)) {
+    return [self _decodeObjectOfClass:Nil allowNull:allowNull isKey:NO];
+  }
+  cmp_object_t o;
+  if (!cmp_read_object(&_cmpContext, &o)) {
+    [self failWithErrorCode:NSNotFound];
+    return nil;
+  }
+  switch (o.type) {
+    case CMP_TYPE_MAP16:
+    case CMP_TYPE_MAP32:
+    case CMP_TYPE_FIXMAP: {
+      if (_collectsStatistics) {
+        PINUnpackerRecordObject(self, o.type);
+      }
+      // Copy immutable dictionaries, keeping their keys, and return the copy.
+      NSMutableDictionary *dictionary;
+      if (PINMergeCanMutate(object, [NSMutableDictionary class])) {
+        dictionary = object;
+      } else if ([object isKindOfClass:[NSDictionary class]]) {
+        dictionary = [object mutableCopy];
+      } else {
+        dictionary = [[NSMutableDictionary alloc] initWithCapacity:o.as.map_size];
+      }
+      if (![self _decodeDictionaryWithCount:o.as.map_size keyClass:Nil objectClass:Nil intoDictionary:dictionary merging:YES]) {
+        return nil;
+      }
+      return dictionary;
+    }
+    case CMP_TYPE_ARRAY16:
+    case CMP_TYPE_ARRAY32:
+    case CMP_TYPE_FIXARRAY: {
+      if (_collectsStatistics) {
+        PINUnpackerRecordObject(self, o.type);
+      }
+      NSMutableArray *array;
+      if (PINMergeCanMutate(object, [NSMutableArray class])) {
+        array = object;
+      } else if ([object isKindOfClass:[NSArray class]]) {
+        array = [object mutableCopy];
+      } else {
+        array = [[NSMutableArray alloc] initWithCapacity:o.as.array_size];
+      }
+      if (![self _decodeArrayWithCount:o.as.array_size class:Nil intoArray:array merging:YES]) {
+        return nil;
+      }
+      return array;
+    }
+    default:
+      [self failWithErrorCode:PINMessagePackInternalError];
+      return nil;
+  }
+}
+
+- (BOOL)_decodeArrayWithCount:(NSUInteger)count class:(Class)class intoArray:(NSMutableArray *)array merging:(BOOL)merging
+{
+  PINUnpackerRecordContainer(self, count);
+  const NSUInteger oldCount = array.count;
+  BOOL success = YES;
+  _depth++;
+  for (NSUInteger i = 0; i < count; i++) {
+    id existing = (i < oldCount ? array[i] : nil);
+    id value = (merging ? [self _decodeObjectMergingIntoObject:existing allowNull:YES] : [self _decodeObjectOfClass:class allowNull:YES isKey:NO]);
+    if (value == nil) {
+      success = NO;
+      break;
+    }
+    if (i >= oldCount) {
+      [array addObject:value];
+    } else if (value != existing) {
+      [array replaceObjectAtIndex:i withObject:value];
+    }
+  }
+  _depth--;
+  if (success && count < oldCount) {
+    [array removeObjectsInRange:NSMakeRange(count, oldCount - count)];
+  }
+  return success;
+}
+
+- (BOOL)_decodeDictionaryWithCount:(NSUInteger)count keyClass:(Class)keyClass objectClass:(Class)objectClass intoDictionary:(NSMutableDictionary *)dictionary merging:(BOOL)merging
+{
+  PINUnpackerRecordContainer(self, count);
+  if (keyClass == Nil && self.forcesMapKeysToString) {
+    keyClass = [NSString class];
+  }
+  
+  // When replacing, keep the keys in case we need to remove others at the end.
+  CFTypeRef stackKeys[kPINStackCollectionCount];
+  PINScratchMark mark = PINScratchGetMark(&_scratch);
+  CFTypeRef *keys = NULL;
+  if (!merging) {
+    keys = (count <= kPINStackCollectionCount ? stackKeys : [self _scratchObjectsWithCount:count]);
+    if (keys == NULL) {
+      [self failWithErrorCode:PINMessagePackErrorMapTooLong];
+      return NO;
+    }
+  }
+  
+  NSUInteger i = 0;
+  _depth++;
+  for (; i < count; i++) {
+    id key = [self _decodeObjectOfClass:keyClass allowNull:YES isKey:YES];
+    if (key == nil) {
+      break;
+    }
+    id existing = dictionary[key];
+    id value = (merging ? [self _decodeObjectMergingIntoObject:existing allowNull:YES] : [self _decodeObjectOfClass:objectClass allowNull:YES isKey:NO]);
+    if (value == nil) {
+      break;
+    }
+    if (value != existing) {
+      dictionary[key] = value;
+    }
+    if (keys) {
+      keys[i] = (__bridge_retained CFTypeRef)key;
+    }
+  }
+  _depth--;
+  
+  const BOOL success = (i == count);
+  if (keys) {
+    // If the dictionary has exactly the keys we decoded, there's nothing to remove.
+    if (success && dictionary.count != count) {
+      NSSet *keep = [[NSSet alloc] initWithObjects:(__unsafe_unretained id const *)(void *)keys count:count];
+      NSMutableArray *remove = [[NSMutableArray alloc] init];
+      for (id key in dictionary) {
+        if (![keep containsObject:key]) {
+          [remove addObject:key];
+        }
+      }
+      [dictionary removeObjectsForKeys:remove];
+    }
+    for (NSUInteger j = 0; j < i; j++) {
+      CFRelease(keys[j]);
+    }
+  }
+  PINScratchReset(&_scratch, mark);
+  return success;
+}
+
+#pragma mark - Concurrent Decoding
+
+/// Finds the element boundaries, then decodes stripes of elements on several threads.
+/// Returns nil without an error if the array is too small, after rewinding.
+- (NSArray *)_decodeArrayConcurrentlyWithCount:(NSUInteger)count NS_RETURNS_RETAINED
+{
+  // The array can't be big enough if the rest of the input isn't. Check
+  // before finding the boundaries, so we don't walk it twice.
+  if (PINByteCursorRemaining(&_cursor) < kPINConcurrentArrayMinimumLength) {
+    return nil;
+  }
+  
+  // Every element takes at least one byte.
+  NSUInteger *offsets = (count <= PINByteCursorRemaining(&_cursor) ? malloc((count + 1) * sizeof(NSUInteger)) : NULL);
+  if (offsets == NULL) {
+    [self failWithErrorCode:PINMessagePackErrorArrayTooLong];
+    return nil;
+  }
+  for (NSUInteger i = 0; i < count; i++) {
+    offsets[i] = _cursor.offset;
+    if (!cmp_skip_object_no_limit(&_cmpContext)) {
+      [self failWithErrorCode:NSNotFound];
+      free(offsets);
+      return nil;
+    }
+  }
+  offsets[count] = _cursor.offset;
+  if (offsets[count] - offsets[0] < kPINConcurrentArrayMinimumLength) {
+    _cursor.offset = offsets[0];
+    free(offsets);
+    return nil;
+  }
+  
+  // Several stripes per thread, so that uneven elements balance out. Each
+  // thread claims the next stripe until they're gone.
+  const NSUInteger threads = MIN(_decodingConcurrency, count);
+  CFTypeRef *vals = calloc(count, sizeof(CFTypeRef));
+  // Each thread's statistics, merged into ours once they're done.
+  PINDecodingStatistics *threadStatistics = (_collectsStatistics ? calloc(threads, sizeof(PINDecodingStatistics)) : NULL);
+  if (vals == NULL || (_collectsStatistics && threadStatistics == NULL)) {
+    free(vals);
+    free(threadStatistics);
+    free(offsets);
+    [self failWithErrorCode:PINMessagePackErrorArrayTooLong];
+    return nil;
+  }
+  const PINLazyDecodingOptions options = [self _lazyDecodingOptions];
+  const BOOL decodesLazily = _decodesLazily;
+  const BOOL collectsStatistics = _collectsStatistics;
+  // The elements are inside the array, as when decoding serially.
+  const NSUInteger depth = _depth + 1;
+  NSData *data = _data;
+  const PINByteCursor cursor = _cursor;
+  
+  const NSUInteger stripeCount = MIN(threads * 4, count);
+  _Atomic(NSUInteger) nextStripe = 0;
+  _Atomic(uint8_t) error = 0;
+  _Atomic(NSUInteger) *nextStripePtr = &nextStripe;
+  _Atomic(uint8_t) *errorPtr = &error;
+#ifdef __APPLE__
+  dispatch_queue_t queue = dispatch_get_global_queue(qos_class_self(), 0);
+#else
+  dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+#endif
+  dispatch_apply(threads, queue, ^(size_t t) {
+    PINMessageUnpacker *unpacker = (data ? [[PINMessageUnpacker alloc] initWithData:data] : [[PINMessageUnpacker alloc] initWithBytes:cursor.bytes length:cursor.length]);
+    [unpacker _applyLazyDecodingOptions:&options];
+    unpacker->_decodesLazily = decodesLazily;
+    unpacker->_collectsStatistics = collectsStatistics;
+    unpacker->_depth = depth;
+    
+    NSUInteger stripe;
+    while ((stripe = atomic_fetch_add(nextStripePtr, 1)) < stripeCount && atomic_load(errorPtr) == 0) {
+      const NSUInteger start = count * stripe / stripeCount;
+      const NSUInteger end = count * (stripe + 1) / stripeCount;
+      unpacker->_cursor.offset = offsets[start];
+      for (NSUInteger i = start; i < end; i++) {
+        vals[i] = (__bridge_retained CFTypeRef)[unpacker _decodeObjectOfClass:Nil allowNull:YES isKey:NO];
+        if (vals[i] == NULL) {
+          uint8_t expected = 0;
+          atomic_compare_exchange_strong(errorPtr, &expected, unpacker->_cmpContext.error ?: PINMessagePackInternalError);
+          break;
+        }
+      }
+    }
+    if (threadStatistics) {
+      threadStatistics[t] = unpacker->_statistics;
+    }
+  });
+  
+  if (threadStatistics) {
+    for (NSUInteger t = 0; t < threads; t++) {
+      for (NSUInteger type = 0; type < PINMessagePackTypeCount; type++) {
+        _statistics.objectCounts[type] += threadStatistics[t].objectCounts[type];
+      }
+      _statistics.maximumDepth = MAX(_statistics.maximumDepth, threadStatistics[t].maximumDepth);
+      _statistics.largestContainerCount = MAX(_statistics.largestContainerCount, threadStatistics[t].largestContainerCount);
+    }
+    free(threadStatistics);
+  }
+  
+  NSArray *result = nil;
+  if (error == 0) {
+    result = [NSArray pin_arrayWithRetainedObjects:vals count:count];
+  } else {
+    // Elements that weren't decoded are still NULL.
+    for (NSUInteger i = 0; i < count; i++) {
+      if (vals[i]) {
+        CFRelease(vals[i]);
+      }
+    }
+    // The element already reported the error.
+    _cmpContext.error = error;
+  }
+  free(vals);
+  free(offsets);
+  return result;
+}
+
+#pragma mark - Lazy Decoding
+
+/// Whether lazy decoding is on and we retain contiguous input. If our
+/// buffer has completed, this switches us over to reading its data directly.
+/// That copies the data, unless only one chunk is left.
+- (BOOL)_canDecodeLazily
+{
+  if (!_decodesLazily) {
+    return NO;
+  }
+  if (_buffer && _buffer.state == PINBufferStateCompleted) {
+    _data = [_buffer readRemainingData];
+    _drainedBuffer = _buffer;
+    _buffer = nil;
+    _cursor = PINByteCursorMake(_data.bytes, _data.length);
+    cmp_init(&_cmpContext, &_cursor, data_reader, data_skipper, NULL);
+  }
+  return (_data != nil);
+}
+
+- (PINLazyDecodingOptions)_lazyDecodingOptions
+{
+  return (PINLazyDecodingOptions){
+    .forcesMapKeysToString = _forcesMapKeysToString,
+    .internsMapKeys = _internsMapKeys,
+    .decodesBinaryDataWithoutCopying = _decodesBinaryDataWithoutCopying,
+    .maximumInternedValueLength = _maximumInternedValueLength,
+    .extensionHandlers = _extensionHandlers
+  };
+}
+
+- (void)_applyLazyDecodingOptions:(const PINLazyDecodingOptions *)options
+{
+  _forcesMapKeysToString = options->forcesMapKeysToString;
+  _internsMapKeys = options->internsMapKeys;
+  _decodesBinaryDataWithoutCopying = options->decodesBinaryDataWithoutCopying;
+  _maximumInternedValueLength = options->maximumInternedValueLength;
+  _extensionHandlers = options->extensionHandlers;
+}
+
+/// The context for the lazy collections we decode. Collections from the
+/// same message share one, as long as our options haven't changed.
+- (PINLazyDecodingContext *)_lazyDecodingContext
+{
+  const PINLazyDecodingOptions options = [self _lazyDecodingOptions];
+  PINLazyDecodingContext *context = _lazyContext;
+  if (context == nil || context.data != _data || !PINLazyDecodingOptionsEqual(context.options, options)) {
+    context = [[PINLazyDecodingContext alloc] initWithData:_data options:options];
+    _lazyContext = context;
+  }
+  return context;
+}
+
+- (NSArray *)_decodeLazyArrayWithCount:(NSUInteger)count NS_RETURNS_RETAINED
+{
+  // Every element takes at least one byte.
+  NSUInteger *offsets = (count <= PINByteCursorRemaining(&_cursor) ? malloc(count * sizeof(NSUInteger)) : NULL);
+  if (offsets == NULL) {
+    [self failWithErrorCode:PINMessagePackErrorArrayTooLong];
+    return nil;
+  }
+  for (NSUInteger i = 0; i < count; i++) {
+    offsets[i] = _cursor.offset;
+    if (!cmp_skip_object_no_limit(&_cmpContext)) {
+      [self failWithErrorCode:NSNotFound];
+      free(offsets);
+      return nil;
+    }
+  }
+  return [[PINLazyArray alloc] initWithContext:[self _lazyDecodingContext] offsets:offsets count:count];
+}
+
+- (NSDictionary *)_decodeLazyDictionaryWithCount:(NSUInteger)count keyClass:(Class)keyClass NS_RETURNS_RETAINED
+{
+  CFTypeRef stackKeys[kPINStackCollectionCount];
+  PINScratchMark mark = PINScratchGetMark(&_scratch);
+  CFTypeRef *keys = (count <= kPINStackCollectionCount ? stackKeys : [self _scratchObjectsWithCount:count]);
+  NSUInteger *offsets = (keys ? malloc(count * sizeof(NSUInteger)) : NULL);
+  if (offsets == NULL) {
+    PINScratchReset(&_scratch, mark);
+    [self failWithErrorCode:PINMessagePackErrorMapTooLong];
+    return nil;
+  }
+  if (keyClass == Nil && self.forcesMapKeysToString) {
+    keyClass = [NSString class];
+  }
+  
+  NSUInteger i = 0;
+  for (; i < count; i++) {
+    if (!(keys[i] = (__bridge_retained CFTypeRef)[self _decodeObjectOfClass:keyClass allowNull:YES isKey:YES])) {
+      break;
+    }
+    offsets[i] = _cursor.offset;
+    if (!cmp_skip_object_no_limit(&_cmpContext)) {
+      [self failWithErrorCode:NSNotFound];
+      CFRelease(keys[i]);
+      break;
+    }
+  }
+  
+  NSDictionary *result = nil;
+  if (i == count) {
+    result = [[PINLazyDictionary alloc] initWithContext:[self _lazyDecodingContext] retainedKeys:keys offsets:offsets count:count];
+  } else {
+    for (NSUInteger j = 0; j < i; j++) {
+      CFRelease(keys[j]);
+    }
+    free(offsets);
+  }
+  PINScratchReset(&_scratch, mark);
+  return result;
+}
+
+PINMessageUnpacker *PINLazyUnpackerCreate(PINLazyDecodingContext *context)
+{
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:context.data];
+  const PINLazyDecodingOptions options = context.options;
+  [unpacker _applyLazyDecodingOptions:&options];
+  unpacker->_decodesLazily = YES;
+  unpacker->_decodesLazyElements = YES;
+  // Nested collections join the same context.
+  unpacker->_lazyContext = context;
+  return unpacker;
+}
+
+id PINLazyUnpackerDecodeObject(PINMessageUnpacker *unpacker, NSUInteger offset)
+{
+  unpacker->_cursor.offset = offset;
+  unpacker->_cmpContext.error = 0;
+  return [unpacker _decodeObjectOfClass:Nil allowNull:YES isKey:NO];
+}
+
 @end
@@ -0,0 +1,32 @@
+//
+//  PINNumberCache.m
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINNumberCache.h"
+
+const CFNumberRef *PINNumberCacheGetNumbers(void)
+{
+  static CFNumberRef numbers[kPINNumberCacheMax - kPINNumberCacheMin + 1];
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    // Use the types a fixnum or uint8 would decode as: int8, and int16
+    // for uint8 like NSNumber does. Equal values share a number however
+    // they were encoded, so e.g. an int32 of 5 gets an objCType of 'c'
+    // rather than 'i'. Equality, hashing and value accessors don't
+    // depend on the type.
+    for (int64_t v = kPINNumberCacheMin; v <= kPINNumberCacheMax; v++) {
+      if (v <= INT8_MAX) {
+        const SInt8 s8 = (SInt8)v;
+        numbers[v - kPINNumberCacheMin] = CFNumberCreate(NULL, kCFNumberSInt8Type, &s8);
+      } else {
+        const SInt16 s16 = (SInt16)v;
+        numbers[v - kPINNumberCacheMin] = CFNumberCreate(NULL, kCFNumberSInt16Type, &s16);
+      }
+    }
+  });
+  return numbers;
+}
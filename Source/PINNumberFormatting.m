@@ -0,0 +1,345 @@
+//
+//  PINNumberFormatting.m
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINNumberFormatting.h"
+
+static const char kPINDigitPairs[201] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+size_t PINFormatUInt64(uint64_t value, char *buffer)
+{
+  // Write backward from the end, then move the digits to the front.
+  char digits[20];
+  char *p = digits + sizeof(digits);
+  while (value >= 100) {
+    const size_t pair = (size_t)(value % 100) * 2;
+    value /= 100;
+    p -= 2;
+    memcpy(p, kPINDigitPairs + pair, 2);
+  }
+  if (value >= 10) {
+    p -= 2;
+    memcpy(p, kPINDigitPairs + value * 2, 2);
+  } else {
+    *--p = (char)('0' + value);
+  }
+  const size_t length = (size_t)(digits + sizeof(digits) - p);
+  memcpy(buffer, p, length);
+  return length;
+}
+
+size_t PINFormatInt64(int64_t value, char *buffer)
+{
+  if (value < 0) {
+    buffer[0] = '-';
+    // Negate as unsigned, so that INT64_MIN works.
+    return 1 + PINFormatUInt64(0 - (uint64_t)value, buffer + 1);
+  }
+  return PINFormatUInt64((uint64_t)value, buffer);
+}
+
+#pragma mark - Grisu2
+
+// Grisu2, as described in Florian Loitsch, "Printing Floating-Point Numbers
+// Quickly and Accurately with Integers" (PLDI 2010), structured like the
+// double-conversion and RapidJSON implementations.
+
+/// A floating point number with a 64-bit significand: f * 2^e.
+typedef struct {
+  uint64_t f;
+  int e;
+} PINDiyFp;
+
+static PINDiyFp PINDiyFpNormalize(PINDiyFp x)
+{
+  const int shift = __builtin_clzll(x.f);
+  return (PINDiyFp){ x.f << shift, x.e - shift };
+}
+
+/// The product, rounded to 64 bits. Portable to 32-bit platforms.
+static PINDiyFp PINDiyFpMultiply(PINDiyFp x, PINDiyFp y)
+{
+  const uint64_t M32 = 0xFFFFFFFF;
+  const uint64_t a = x.f >> 32, b = x.f & M32, c = y.f >> 32, d = y.f & M32;
+  const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+  uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+  tmp += 1U << 31;
+  return (PINDiyFp){ ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64 };
+}
+
+/// 10^k for k = -348, -340, ..., 340, rounded to 64 bits.
+static const uint64_t kPINCachedPowerSignificands[] = {
+  0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+  0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+  0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+  0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+  0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+  0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+  0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+  0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+  0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+  0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+  0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+  0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+  0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+  0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+  0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+  0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+  0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+  0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+  0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+  0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+  0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+  0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+  0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+  0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+  0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+  0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+  0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+  0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+  0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+};
+
+static const int16_t kPINCachedPowerExponents[] = {
+  -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+  -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+  -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+  -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+  56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+  375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+  694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+  1013, 1039, 1066
+
+};
+
+/// Returns a cached 10^-k whose product with a value of binary exponent `e`
+/// has a binary exponent in [-60, -32], and sets `k`.
+static PINDiyFp PINCachedPowerForBinaryExponent(int e, int *k)
+{
+  const double dk = (-61 - e) * 0.30102999566398114 + 347; // dk must be positive, so we can round up by truncating.
+  int ik = (int)dk;
+  if (dk - ik > 0.0) {
+    ik++;
+  }
+  const unsigned index = (unsigned)((ik >> 3) + 1);
+  *k = -(-348 + (int)(index << 3));
+  return (PINDiyFp){ kPINCachedPowerSignificands[index], kPINCachedPowerExponents[index] };
+}
+
+static const uint32_t kPINPowersOf10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+static int PINCountDecimalDigits(uint32_t n)
+{
+  int count = 1;
+  while (count < 10 && n >= kPINPowersOf10[count]) {
+    count++;
+  }
+  return count;
+}
+
+/// Moves the last digit toward w while staying inside the boundaries.
+static void PINGrisuRound(char *buffer, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance)
+{
+  while (rest < distance && delta - rest >= tenKappa &&
+         (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance)) {
+    buffer[length - 1]--;
+    rest += tenKappa;
+  }
+}
+
+/// Generates the shortest digits of w within (low, high), as digits * 10^k.
+static int PINGrisuDigitGen(PINDiyFp w, PINDiyFp high, uint64_t delta, char *buffer, int *k)
+{
+  const PINDiyFp one = { (uint64_t)1 << -high.e, high.e };
+  const uint64_t distance = high.f - w.f;
+  uint32_t p1 = (uint32_t)(high.f >> -one.e);
+  uint64_t p2 = high.f & (one.f - 1);
+  int kappa = PINCountDecimalDigits(p1);
+  int length = 0;
+
+  // The integral part.
+  while (kappa > 0) {
+    const uint32_t divisor = kPINPowersOf10[kappa - 1];
+    const uint32_t d = p1 / divisor;
+    p1 %= divisor;
+    if (d || length) {
+      buffer[length++] = (char)('0' + d);
+    }
+    kappa--;
+    const uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+    if (rest <= delta) {
+      *k += kappa;
+      PINGrisuRound(buffer, length, delta, rest, (uint64_t)kPINPowersOf10[kappa] << -one.e, distance);
+      return length;
+    }
+  }
+
+  // The fractional part.
+  uint64_t unit = 1;
+  for (;;) {
+    p2 *= 10;
+    delta *= 10;
+    unit *= 10;
+    const char d = (char)(p2 >> -one.e);
+    if (d || length) {
+      buffer[length++] = (char)('0' + d);
+    }
+    p2 &= one.f - 1;
+    kappa--;
+    if (p2 < delta) {
+      *k += kappa;
+      PINGrisuRound(buffer, length, delta, p2, one.f, distance * unit);
+      return length;
+    }
+  }
+}
+
+/**
+ * Writes the digits of a positive value given as f * 2^e, whose neighbors
+ * are half an ulp away, or a quarter below if f is the smallest significand
+ * of its binade. Returns the length, and sets `k` so that value ≈ digits * 10^k.
+ */
+static int PINGrisu2(uint64_t f, int e, uint64_t hiddenBit, char *buffer, int *k)
+{
+  const PINDiyFp v = { f, e };
+  const PINDiyFp high = PINDiyFpNormalize((PINDiyFp){ (f << 1) + 1, e - 1 });
+  PINDiyFp low = (f == hiddenBit ? (PINDiyFp){ (f << 2) - 1, e - 2 } : (PINDiyFp){ (f << 1) - 1, e - 1 });
+  low.f <<= low.e - high.e;
+  low.e = high.e;
+
+  const PINDiyFp cachedPower = PINCachedPowerForBinaryExponent(high.e, k);
+  const PINDiyFp w = PINDiyFpMultiply(PINDiyFpNormalize(v), cachedPower);
+  PINDiyFp wHigh = PINDiyFpMultiply(high, cachedPower);
+  PINDiyFp wLow = PINDiyFpMultiply(low, cachedPower);
+  // Stay inside the boundaries despite rounding in the products.
+  wLow.f++;
+  wHigh.f--;
+  return PINGrisuDigitGen(w, wHigh, wHigh.f - wLow.f, buffer, k);
+}
+
+static size_t PINWriteExponent(int exponent, char *buffer)
+{
+  char *p = buffer;
+  *p++ = 'e';
+  if (exponent < 0) {
+    *p++ = '-';
+    exponent = -exponent;
+  } else {
+    *p++ = '+';
+  }
+  return (size_t)(p - buffer) + PINFormatUInt64((uint64_t)exponent, p);
+}
+
+/// Lays out digits * 10^k in `buffer`, where the digits already are. Returns the length.
+static size_t PINPrettify(char *buffer, int length, int k)
+{
+  // The position of the decimal point: 10^(point - 1) <= value < 10^point.
+  const int point = length + k;
+  if (k >= 0 && point <= 21) {
+    // 1234e7 -> 12340000000
+    memset(buffer + length, '0', (size_t)k);
+    return (size_t)point;
+  } else if (point > 0 && point <= 21) {
+    // 1234e-2 -> 12.34
+    memmove(buffer + point + 1, buffer + point, (size_t)(length - point));
+    buffer[point] = '.';
+    return (size_t)length + 1;
+  } else if (point > -6 && point <= 0) {
+    // 1234e-6 -> 0.001234
+    const int offset = 2 - point;
+    memmove(buffer + offset, buffer, (size_t)length);
+    buffer[0] = '0';
+    buffer[1] = '.';
+    memset(buffer + 2, '0', (size_t)(offset - 2));
+    return (size_t)(length + offset);
+  } else if (length == 1) {
+    // 1e30
+    return 1 + PINWriteExponent(point - 1, buffer + 1);
+  } else {
+    // 1234e30 -> 1.234e+33
+    memmove(buffer + 2, buffer + 1, (size_t)(length - 1));
+    buffer[1] = '.';
+    return (size_t)length + 1 + PINWriteExponent(point - 1, buffer + length + 1);
+  }
+}
+
+/// Handles the sign, zero and non-finite values, for either width.
+static size_t PINFormatSpecial(bool negative, bool isZero, bool isNaN, bool isInfinite, char *buffer, size_t *signLength)
+{
+  if (isNaN) {
+    memcpy(buffer, "nan", 3);
+    return 3;
+  }
+  *signLength = 0;
+  if (negative) {
+    buffer[0] = '-';
+    *signLength = 1;
+  }
+  if (isInfinite) {
+    memcpy(buffer + *signLength, "inf", 3);
+    return *signLength + 3;
+  }
+  if (isZero) {
+    buffer[*signLength] = '0';
+    return *signLength + 1;
+  }
+  return 0;
+}
+
+size_t PINFormatDouble(double value, char *buffer)
+{
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const uint64_t hiddenBit = (uint64_t)1 << 52;
+  const uint64_t significand = bits & (hiddenBit - 1);
+  const int biasedExponent = (int)((bits >> 52) & 0x7FF);
+
+  size_t signLength;
+  const size_t special = PINFormatSpecial(bits >> 63, biasedExponent == 0 && significand == 0, biasedExponent == 0x7FF && significand != 0, biasedExponent == 0x7FF && significand == 0, buffer, &signLength);
+  if (special > 0) {
+    return special;
+  }
+
+  const uint64_t f = (biasedExponent != 0 ? significand + hiddenBit : significand);
+  const int e = (biasedExponent != 0 ? biasedExponent : 1) - 1075;
+  int k;
+  char *digits = buffer + signLength;
+  const int length = PINGrisu2(f, e, hiddenBit, digits, &k);
+  return signLength + PINPrettify(digits, length, k);
+}
+
+size_t PINFormatFloat(float value, char *buffer)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const uint32_t hiddenBit = (uint32_t)1 << 23;
+  const uint32_t significand = bits & (hiddenBit - 1);
+  const int biasedExponent = (int)((bits >> 23) & 0xFF);
+
+  size_t signLength;
+  const size_t special = PINFormatSpecial(bits >> 31, biasedExponent == 0 && significand == 0, biasedExponent == 0xFF && significand != 0, biasedExponent == 0xFF && significand == 0, buffer, &signLength);
+  if (special > 0) {
+    return special;
+  }
+
+  const uint64_t f = (biasedExponent != 0 ? significand + hiddenBit : significand);
+  const int e = (biasedExponent != 0 ? biasedExponent : 1) - 150;
+  int k;
+  char *digits = buffer + signLength;
+  const int length = PINGrisu2(f, e, hiddenBit, digits, &k);
+  return signLength + PINPrettify(digits, length, k);
+}
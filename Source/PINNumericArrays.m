@@ -0,0 +1,207 @@
+//
+//  PINNumericArrays.m
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINNumericArrays.h"
+
+NS_INLINE uint16_t PINLoadBig16(const uint8_t *p)
+{
+  uint16_t v;
+  memcpy(&v, p, sizeof(v));
+  return CFSwapInt16BigToHost(v);
+}
+
+NS_INLINE uint32_t PINLoadBig32(const uint8_t *p)
+{
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return CFSwapInt32BigToHost(v);
+}
+
+NS_INLINE uint64_t PINLoadBig64(const uint8_t *p)
+{
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return CFSwapInt64BigToHost(v);
+}
+
+NS_INLINE void PINStoreInteger(void *values, PINNumericType type, NSUInteger i, int64_t v)
+{
+  switch (type) {
+    case PINNumericTypeInt64:
+      ((int64_t *)values)[i] = v;
+      break;
+    case PINNumericTypeDouble:
+      ((double *)values)[i] = (double)v;
+      break;
+    case PINNumericTypeFloat:
+      ((float *)values)[i] = (float)v;
+      break;
+  }
+}
+
+/// Only for double and float.
+NS_INLINE void PINStoreFloating(void *values, PINNumericType type, NSUInteger i, double v)
+{
+  if (type == PINNumericTypeDouble) {
+    ((double *)values)[i] = v;
+  } else {
+    ((float *)values)[i] = (float)v;
+  }
+}
+
+// Each element is a marker byte followed by the value, so the loop checks
+// the marker and byte-swaps the value. The type switch inside is
+// loop-invariant, so the compiler hoists it out.
+#define PIN_DECODE_RUN(store) \
+  for (; n < limit && p[0] == marker; n++, p += stride) { \
+    store; \
+  }
+
+NSUInteger PINNumericArrayDecodeRun(const uint8_t *bytes, size_t length, PINNumericType type, void *values, NSUInteger maxCount, size_t *consumed)
+{
+  *consumed = 0;
+  if (length == 0 || maxCount == 0) {
+    return 0;
+  }
+
+  const uint8_t marker = bytes[0];
+  NSUInteger n = 0;
+
+  // Fixints are their own marker, so a run is any sequence of them.
+  if (marker <= 0x7f || marker >= 0xe0) {
+    const size_t limit = MIN(maxCount, length);
+    for (; n < limit; n++) {
+      const uint8_t b = bytes[n];
+      if (b > 0x7f && b < 0xe0) {
+        break;
+      }
+      PINStoreInteger(values, type, n, (int8_t)b);
+    }
+    *consumed = n;
+    return n;
+  }
+
+  size_t width;
+  switch (marker) {
+    case 0xcc: // uint 8
+    case 0xd0: // int 8
+      width = 1;
+      break;
+    case 0xcd: // uint 16
+    case 0xd1: // int 16
+      width = 2;
+      break;
+    case 0xce: // uint 32
+    case 0xd2: // int 32
+      width = 4;
+      break;
+    case 0xca: // float 32
+      if (type == PINNumericTypeInt64) {
+        return 0;
+      }
+      width = 4;
+      break;
+    case 0xcf: // uint 64
+    case 0xd3: // int 64
+      width = 8;
+      break;
+    case 0xcb: // float 64
+      if (type == PINNumericTypeInt64) {
+        return 0;
+      }
+      width = 8;
+      break;
+    default:
+      return 0;
+  }
+
+  const size_t stride = width + 1;
+  const size_t limit = MIN(maxCount, length / stride);
+  const uint8_t *p = bytes;
+  switch (marker) {
+    case 0xcc:
+      PIN_DECODE_RUN(PINStoreInteger(values, type, n, p[1]));
+      break;
+    case 0xd0:
+      PIN_DECODE_RUN(PINStoreInteger(values, type, n, (int8_t)p[1]));
+      break;
+    case 0xcd:
+      PIN_DECODE_RUN(PINStoreInteger(values, type, n, PINLoadBig16(p + 1)));
+      break;
+    case 0xd1:
+      PIN_DECODE_RUN(PINStoreInteger(values, type, n, (int16_t)PINLoadBig16(p + 1)));
+      break;
+    case 0xce:
+      PIN_DECODE_RUN(PINStoreInteger(values, type, n, PINLoadBig32(p + 1)));
+      break;
+    case 0xd2:
+      PIN_DECODE_RUN(PINStoreInteger(values, type, n, (int32_t)PINLoadBig32(p + 1)));
+      break;
+    case 0xd3:
+      PIN_DECODE_RUN(PINStoreInteger(values, type, n, (int64_t)PINLoadBig64(p + 1)));
+      break;
+    case 0xcf:
+      if (type == PINNumericTypeInt64) {
+        // Stop at values that don't fit.
+        for (; n < limit && p[0] == marker; n++, p += stride) {
+          const uint64_t v = PINLoadBig64(p + 1);
+          if (v > INT64_MAX) {
+            break;
+          }
+          PINStoreInteger(values, type, n, (int64_t)v);
+        }
+      } else {
+        PIN_DECODE_RUN(PINStoreFloating(values, type, n, (double)PINLoadBig64(p + 1)));
+      }
+      break;
+    case 0xca:
+      PIN_DECODE_RUN({
+        const uint32_t bits = PINLoadBig32(p + 1);
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        PINStoreFloating(values, type, n, f);
+      });
+      break;
+    case 0xcb:
+      PIN_DECODE_RUN({
+        const uint64_t bits = PINLoadBig64(p + 1);
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        PINStoreFloating(values, type, n, d);
+      });
+      break;
+  }
+  *consumed = n * stride;
+  return n;
+}
+
+bool PINNumericArrayStoreObject(const cmp_object_t *object, PINNumericType type, void *values, NSUInteger index)
+{
+  cmp_object_t o = *object;
+  int64_t s;
+  if (cmp_object_as_long(&o, &s)) {
+    PINStoreInteger(values, type, index, s);
+    return true;
+  }
+  if (type == PINNumericTypeInt64) {
+    return false;
+  }
+  switch (o.type) {
+    case CMP_TYPE_UINT64:
+      PINStoreFloating(values, type, index, (double)o.as.u64);
+      return true;
+    case CMP_TYPE_FLOAT:
+      PINStoreFloating(values, type, index, o.as.flt);
+      return true;
+    case CMP_TYPE_DOUBLE:
+      PINStoreFloating(values, type, index, o.as.dbl);
+      return true;
+    default:
+      return false;
+  }
+}
@@ -0,0 +1,66 @@
+//
+//  PINScratch.m
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINScratch.h"
+
+static const size_t kPINScratchMinimumBlockSize = 16 * 1024;
+
+static void PINScratchFreeBlocks(PINScratchBlock *block)
+{
+  while (block) {
+    PINScratchBlock *next = block->next;
+    free(block);
+    block = next;
+  }
+}
+
+void *PINScratchAlloc(PINScratch *scratch, size_t size)
+{
+  const size_t alignment = sizeof(void *);
+  if (size > SIZE_MAX - sizeof(PINScratchBlock) - alignment) {
+    return NULL;
+  }
+  size = (size + alignment - 1) & ~(alignment - 1);
+  
+  PINScratchBlock *block = scratch->current;
+  if (block && block->size - block->used >= size) {
+    void *result = block->data + block->used;
+    block->used += size;
+    return result;
+  }
+  
+  // Move on to the next block. Everything after the current block is unused,
+  // since allocations are released in order.
+  PINScratchBlock *next = (block ? block->next : scratch->first);
+  if (next == NULL || next->size < size) {
+    // Replace the unused tail with a block that's big enough.
+    PINScratchFreeBlocks(next);
+    size_t blockSize = MAX(size, (block ? block->size * 2 : kPINScratchMinimumBlockSize));
+    next = malloc(sizeof(PINScratchBlock) + blockSize);
+    if (block) {
+      block->next = next;
+    } else {
+      scratch->first = next;
+    }
+    if (next == NULL) {
+      return NULL;
+    }
+    next->next = NULL;
+    next->size = blockSize;
+  }
+  next->used = size;
+  scratch->current = next;
+  return next->data;
+}
+
+void PINScratchDestroy(PINScratch *scratch)
+{
+  PINScratchFreeBlocks(scratch->first);
+  scratch->first = NULL;
+  scratch->current = NULL;
+}
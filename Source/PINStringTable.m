@@ -0,0 +1,103 @@
+//
+//  PINStringTable.m
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import "PINStringTable.h"
+
+typedef struct {
+  uint32_t hash;
+  uint32_t length;
+  uint8_t *bytes;
+  CFStringRef string;
+} PINStringTableEntry;
+
+struct PINStringTable {
+  PINStringTableEntry *entries;
+  // Always a power of two, at least twice maxCount so probes stay short.
+  size_t capacity;
+  size_t count;
+  size_t maxCount;
+};
+
+/// FNV-1a. Keys are short, so this beats anything fancier.
+NS_INLINE uint32_t PINStringTableHash(const uint8_t *bytes, size_t length)
+{
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/// Returns the entry for these bytes, or the empty entry where they belong.
+NS_INLINE PINStringTableEntry *PINStringTableFind(PINStringTable *table, const uint8_t *bytes, size_t length, uint32_t hash)
+{
+  size_t mask = table->capacity - 1;
+  for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+    PINStringTableEntry *entry = &table->entries[i];
+    if (entry->string == NULL) {
+      return entry;
+    }
+    if (entry->hash == hash && entry->length == length && memcmp(entry->bytes, bytes, length) == 0) {
+      return entry;
+    }
+  }
+}
+
+PINStringTable *PINStringTableCreate(NSUInteger maxCount)
+{
+  PINStringTable *table = calloc(1, sizeof(PINStringTable));
+  size_t capacity = 16;
+  while (capacity < maxCount * 2) {
+    capacity *= 2;
+  }
+  table->entries = calloc(capacity, sizeof(PINStringTableEntry));
+  table->capacity = capacity;
+  table->maxCount = maxCount;
+  return table;
+}
+
+void PINStringTableDestroy(PINStringTable *table)
+{
+  for (size_t i = 0; i < table->capacity; i++) {
+    PINStringTableEntry *entry = &table->entries[i];
+    if (entry->string) {
+      CFRelease(entry->string);
+      free(entry->bytes);
+    }
+  }
+  free(table->entries);
+  free(table);
+}
+
+CFStringRef PINStringTableGet(PINStringTable *table, const void *bytes, size_t length)
+{
+  if (table->count == 0) {
+    return NULL;
+  }
+  uint32_t hash = PINStringTableHash(bytes, length);
+  return PINStringTableFind(table, bytes, length, hash)->string;
+}
+
+void PINStringTableAdd(PINStringTable *table, const void *bytes, size_t length, CFStringRef string)
+{
+  if (table->count >= table->maxCount || length > UINT32_MAX) {
+    return;
+  }
+  uint32_t hash = PINStringTableHash(bytes, length);
+  PINStringTableEntry *entry = PINStringTableFind(table, bytes, length, hash);
+  if (entry->string) {
+    return;
+  }
+  entry->hash = hash;
+  entry->length = (uint32_t)length;
+  entry->bytes = malloc(MAX(length, 1));
+  memcpy(entry->bytes, bytes, length);
+  entry->string = CFRetain(string);
+  table->count += 1;
+}
@@ -2600,7 +2600,10 @@ bool cmp_skip_object_limit(cmp_ctx_t *ctx, cmp_object_t *obj, uint32_t limit) {
               break;
           }
 
-          skip_bytes(ctx, size);
+          if (!skip_bytes(ctx, size)) {
+            ctx->error = DATA_READING_ERROR;
+            return false;
+          }
         }
     }
 
@@ -2676,7 +2679,10 @@ bool cmp_skip_object_no_limit(cmp_ctx_t *ctx) {
               break;
           }
 
-          skip_bytes(ctx, size);
+          if (!skip_bytes(ctx, size)) {
+            ctx->error = DATA_READING_ERROR;
+            return false;
+          }
         }
     }
 
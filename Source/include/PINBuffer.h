@@ -16,6 +16,22 @@ typedef NS_ENUM(NSInteger, PINBufferState) {
   PINBufferStateCompleted
 };
 
+/**
+ * Counters for a buffer, collected when `collectsStatistics` is set.
+ */
+typedef struct {
+  /// Bytes handed to the reader, by reads, skips and consumes.
+  uint64_t bytesConsumed;
+  /// Chunks the reader has moved onto.
+  uint64_t chunksProcessed;
+  /// The number of times the reader blocked for more data, and for how long in total.
+  uint64_t waitCount;
+  uint64_t nanosecondsWaiting;
+  /// Mutex acquisitions by the reader and writers. Writers only take the mutex
+  /// to wake a waiting reader.
+  uint64_t lockAcquisitions;
+} PINBufferStatistics;
+
 /**
  * An efficient data buffer, built specifically to avoid copying
  * and to support noncontiguous data.
@@ -28,6 +44,18 @@ typedef NS_ENUM(NSInteger, PINBufferState) {
 __attribute__((objc_subclassing_restricted))
 @interface PINBuffer : NSObject
 
+/**
+ * Creates a completed buffer with the contents of a file.
+ *
+ * The file is memory-mapped and written as a series of chunks without
+ * copying. As the reader finishes with each chunk its pages are released,
+ * so resident memory tracks what's being decoded rather than the file size.
+ *
+ * Returns nil if the file can't be opened or mapped. The file must not be
+ * truncated while the buffer is in use.
+ */
+- (nullable instancetype)initWithContentsOfFile:(NSString *)path error:(NSError **)error;
+
 /**
  * The current state of the buffer.
  */
@@ -43,6 +71,64 @@ __attribute__((objc_subclassing_restricted))
  */
 @property (atomic) BOOL preserveData;
 
+/**
+ * The number of bytes written that the reader hasn't finished with yet.
+ *
+ * Bytes are counted by chunk: a chunk counts in full until the reader
+ * moves past its last byte, since that's when its memory can be released.
+ */
+@property (atomic, readonly) NSUInteger bufferedByteCount;
+
+/**
+ * Once `bufferedByteCount` reaches this many bytes, `hasSpaceAvailable`
+ * becomes NO and -writeData:timeout: blocks until the reader catches up.
+ *
+ * Writes are never split, so the buffer can exceed the mark by up to one chunk.
+ *
+ * Defaults to 0, which means unbounded. Set this before writing.
+ */
+@property (atomic) NSUInteger highWaterMark;
+
+/**
+ * Once the reader drains `bufferedByteCount` to this many bytes after
+ * reaching the high-water mark, writers resume. The gap between the marks
+ * keeps writers from waking up for every chunk.
+ *
+ * Defaults to 0, which means half the high-water mark.
+ */
+@property (atomic) NSUInteger lowWaterMark;
+
+/**
+ * NO from when `bufferedByteCount` reaches the high-water mark until it
+ * drains to the low-water mark. Always YES if there is no high-water mark.
+ *
+ * Writers that can't block, like NSURLSession delegates, should check
+ * this after each write, pause their source while it's NO, and resume it
+ * from `spaceAvailableHandler`.
+ */
+@property (atomic, readonly) BOOL hasSpaceAvailable;
+
+/**
+ * Called when `hasSpaceAvailable` goes back to YES.
+ *
+ * It's usually called on the reader's thread, in the middle of a read,
+ * so it must be quick and must not use the buffer's read methods. Hop to
+ * another queue to do real work.
+ */
+@property (atomic, copy, nullable) dispatch_block_t spaceAvailableHandler;
+
+/**
+ * Whether to collect statistics. Set this before using the buffer.
+ *
+ * When off, which is the default, counting costs a branch at most.
+ */
+@property (nonatomic) BOOL collectsStatistics;
+
+/**
+ * A snapshot of the statistics so far. All zeros unless `collectsStatistics` is set.
+ */
+@property (nonatomic, readonly) PINBufferStatistics statistics;
+
 /**
  * Reads `len` bytes, blocking if needed.
  *
@@ -52,6 +138,72 @@ __attribute__((objc_subclassing_restricted))
  */
 - (BOOL)read:(uint8_t *)buffer length:(NSUInteger)len;
 
+/**
+ * Whether all data has been read and the buffer is closed, blocking if needed.
+ *
+ * Returns NO as soon as there is unread data, or YES once the buffer
+ * closes with nothing left to read.
+ */
+- (BOOL)isAtEnd;
+
+/**
+ * Skips `len` bytes, blocking if needed.
+ *
+ * Whole chunks are skipped without copying any of their bytes.
+ *
+ * Returns YES if the skip succeeded, or NO if the buffer closed before providing the data.
+ *
+ * This method should not be used in conjunction with -readAllData.
+ */
+- (BOOL)skip:(NSUInteger)len;
+
+/**
+ * Reads `len` bytes without copying them, blocking if needed.
+ *
+ * The result retains the chunks it points into. If the range spans chunks,
+ * the pieces are stitched together into a dispatch_data, not flattened.
+ *
+ * Returns nil if the buffer closed before providing the data.
+ */
+- (nullable NSData *)readDataOfLength:(NSUInteger)len NS_RETURNS_RETAINED;
+
+/**
+ * Reads all the unread data, as one contiguous data.
+ *
+ * The buffer must be closed. If only one chunk is left, it is returned
+ * without copying.
+ */
+- (NSData *)readRemainingData NS_RETURNS_RETAINED;
+
+/**
+ * Returns a pointer to the next `len` bytes, in place, if they are all
+ * in the same chunk. Blocks if needed until a chunk is available.
+ *
+ * Returns NULL if the range straddles chunks, or if the buffer closed before
+ * providing any data. In either case nothing is consumed, and you can fall
+ * back to -read:length:.
+ *
+ * The bytes are valid until the next call to -consume:, -read:length: or -skip:.
+ */
+- (nullable const void *)peekContiguousBytes:(NSUInteger)len NS_RETURNS_INNER_POINTER;
+
+/**
+ * Returns a pointer to the rest of the current chunk, in place, and its
+ * length. Blocks if needed until a chunk is available.
+ *
+ * Returns NULL if the buffer closed before providing any data.
+ *
+ * The bytes are valid until the next call to -consume:, -read:length: or -skip:.
+ */
+- (nullable const void *)peekAvailableBytes:(NSUInteger *)length NS_RETURNS_INNER_POINTER;
+
+/**
+ * Advances past `len` bytes returned from -peekContiguousBytes: or -peekAvailableBytes:.
+ *
+ * `len` must not exceed the length that was peeked.
+ */
+- (void)consume:(NSUInteger)len;
+
 /**
  * Retrieve all data in the buffer.
  *
@@ -68,6 +220,15 @@ __attribute__((objc_subclassing_restricted))
  */
 - (NSData *)readAllData NS_RETURNS_RETAINED;
 
+/**
+ * Like -readAllData, but returns the chunks as they were written instead
+ * of copying them into one contiguous data.
+ *
+ * Use this to forward or write out the data, e.g. with NSOutputStream or
+ * dispatch_io, without ever holding two copies of it.
+ */
+- (NSArray<NSData *> *)readAllChunks;
+
 /**
  * Writes a chunk of data.
  *
@@ -79,6 +240,31 @@ __attribute__((objc_subclassing_restricted))
  */
 - (void)writeData:(NSData *)data;
 
+/**
+ * Writes a chunk of data without copying it, taking ownership.
+ *
+ * Use this to hand over mutable data, which -writeData: would have to copy.
+ * The caller must not mutate `data` afterward.
+ */
+- (void)writeDataNoCopy:(NSData *)data;
+
+/**
+ * Writes a chunk of data, first waiting up to `timeout` seconds for space
+ * if the buffer is at its high-water mark.
+ *
+ * Returns NO without writing if the timeout expires, or if the buffer
+ * is closed while waiting.
+ */
+- (BOOL)writeData:(NSData *)data timeout:(NSTimeInterval)timeout;
+
+/**
+ * Writes a dispatch_data without copying or flattening it.
+ *
+ * Each contiguous region becomes its own chunk, so values that span
+ * regions are read the same way as values that span chunks.
+ */
+- (void)writeDispatchData:(dispatch_data_t)data;
+
 /**
  * Indicate that no more data will be put into the buffer.
  *
@@ -0,0 +1,54 @@
+//
+//  PINDecodingPlan.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A precompiled mapping from map keys to the ivars of a class.
+ *
+ * Build one plan per class, once per process, and pass it to
+ * -[PINStreamingDecoder decodeMapIntoObject:withPlan:] from your
+ * -initWithStreamingDecoder: implementation. Keys are looked up with a
+ * perfect hash built from the plan's keys, so decoding a field costs one
+ * hash and one comparison no matter how many fields the class has.
+ *
+ * Field types come from the ivars themselves. Supported types are
+ * signed and unsigned integers of any size, BOOL, float, double and
+ * strong object references. Weak, unsafe_unretained and manually
+ * managed object ivars are rejected. Integers that don't fit their
+ * ivar fail with PINMessagePackErrorInvalidType.
+ *
+ * Plans are immutable, and safe to use from multiple threads.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface PINDecodingPlan : NSObject
+
+/**
+ * Create a plan for the given class.
+ *
+ * @param cls The class whose ivars the values are decoded into.
+ * @param ivarsForKeys The name of the ivar for each map key, e.g. @{ @"id": @"_identifier" }.
+ * @param classesForKeys For object ivars, the class to decode each key's value as.
+ *   This may be any class that -decodeObjectOfClass: supports, including classes
+ *   conforming to PINStreamingDecoding. Keys without a class accept any object.
+ */
+- (instancetype)initWithClass:(Class)cls
+                 ivarsForKeys:(NSDictionary<NSString *, NSString *> *)ivarsForKeys
+               classesForKeys:(nullable NSDictionary<NSString *, Class> *)classesForKeys NS_DESIGNATED_INITIALIZER;
+
+#pragma mark - Unavailable
+
+- (instancetype)init NS_UNAVAILABLE;
+
++ (instancetype)new NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
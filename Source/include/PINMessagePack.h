@@ -17,5 +17,9 @@ FOUNDATION_EXPORT const unsigned char PINMessagePackVersionString[];
 #import <PINMessagePack/PINBuffer.h>
 #import <PINMessagePack/PINMessagePackError.h>
 #import <PINMessagePack/PINStreamingDecoding.h>
+#import <PINMessagePack/PINDecodingPlan.h>
 #import <PINMessagePack/PINMessageUnpacker.h>
+#import <PINMessagePack/PINMessagePushUnpacker.h>
+#import <PINMessagePack/PINStreamingEncoding.h>
+#import <PINMessagePack/PINMessagePacker.h>
 
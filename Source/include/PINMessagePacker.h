@@ -0,0 +1,69 @@
+//
+//  PINMessagePacker.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <PINMessagePack/PINStreamingEncoding.h>
+
+@class PINBuffer;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Encodes objects as MessagePack.
+ *
+ * Output is gathered into large chunks, rather than one allocation per
+ * value. Full chunks are handed off without copying, either into the
+ * buffer you provide or into the data returned from -encodedData.
+ *
+ * Objects of this class are not thread-safe, and must be paired with a lock to
+ * be accessed from multiple threads.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface PINMessagePacker : NSObject<PINStreamingEncoder>
+
+/**
+ * Initialize a packer that collects its output for -encodedData.
+ */
+- (instancetype)init;
+
+/**
+ * Initialize a packer that writes each chunk to the given buffer as it fills.
+ *
+ * Call -flush to push out a partial chunk, for instance at the end of a message.
+ * The packer does not close the buffer.
+ */
+- (instancetype)initWithBuffer:(PINBuffer *)buffer;
+
+/**
+ * Initialize a packer.
+ *
+ * @param buffer The buffer to write chunks into, or nil to collect them for -encodedData.
+ * @param chunkSize The size of each chunk in bytes. Pass 0 for the default (64KB).
+ */
+- (instancetype)initWithBuffer:(nullable PINBuffer *)buffer chunkSize:(NSUInteger)chunkSize NS_DESIGNATED_INITIALIZER;
+
+/**
+ * Write out any partially-filled chunk.
+ *
+ * Partial chunks are copied out so the chunk memory can be reused.
+ */
+- (void)flush;
+
+/**
+ * Retrieve everything encoded since the last call, and reset the packer.
+ *
+ * The result may be noncontiguous (a dispatch_data) if the output spanned
+ * multiple chunks.
+ *
+ * Only valid for packers that were not initialized with a buffer.
+ */
+- (NSData *)encodedData NS_RETURNS_RETAINED;
+
+@end
+
+NS_ASSUME_NONNULL_END
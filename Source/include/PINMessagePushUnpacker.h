@@ -0,0 +1,87 @@
+//
+//  PINMessagePushUnpacker.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <PINMessagePack/PINMessageUnpacker.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Decodes messages from chunks of data as you push them in, without ever
+ * blocking a thread to wait for more.
+ *
+ * Unlike PINMessageUnpacker with a PINBuffer, there is no reader thread.
+ * Call -consumeData: from your network callbacks, and each message is
+ * delivered to the handler, on the same thread, as soon as its last byte
+ * arrives. Between chunks, the position within a partial message is kept
+ * in a small state machine, not on a thread's stack.
+ *
+ * Messages that lie within one chunk are decoded in place. Messages that
+ * span chunks are gathered and then decoded.
+ *
+ * Objects of this class are not thread-safe, and must be paired with a lock to
+ * be accessed from multiple threads.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface PINMessagePushUnpacker : NSObject
+
+/**
+ * Initialize a push unpacker.
+ *
+ * @param class The class of each message, as for -[PINMessageUnpacker decodeObjectOfClass:].
+ * @param messageHandler Called with each message, which is nil for a nil message.
+ */
+- (instancetype)initWithClass:(nullable Class)class messageHandler:(void (^)(id _Nullable message))messageHandler NS_DESIGNATED_INITIALIZER;
+
+/**
+ * The unpacker that decodes each message. Set decoding options,
+ * such as `internsMapKeys`, on it before consuming any data.
+ */
+@property (nonatomic, readonly) PINMessageUnpacker *unpacker;
+
+/**
+ * The longest message to accept, in bytes, or 0 for no limit.
+ *
+ * Messages that span chunks are gathered in memory, and a header can
+ * claim up to 4 GB for one string or binary value. Set this when the
+ * stream isn't trusted. A longer message fails with
+ * PINMessagePackErrorInputTooLarge, as soon as that many bytes of it
+ * have arrived.
+ *
+ * Defaults to 0.
+ */
+@property (nonatomic) NSUInteger maximumMessageLength;
+
+/**
+ * The error that stopped decoding, if any.
+ */
+@property (nonatomic, nullable, readonly) NSError *error;
+
+/**
+ * Decode the next chunk of the stream, delivering any messages it completes.
+ *
+ * Returns NO if the stream is invalid. After that, further data is ignored.
+ */
+- (BOOL)consumeData:(NSData *)data;
+
+/**
+ * Whether the stream so far ends at a message boundary.
+ *
+ * Check this when the stream ends, to find out if it was cut off mid-message.
+ */
+@property (nonatomic, readonly, getter=isAtMessageBoundary) BOOL atMessageBoundary;
+
+#pragma mark - Unavailable
+
+- (instancetype)init NS_UNAVAILABLE;
+
++ (instancetype)new NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -10,9 +10,81 @@
 #import <PINMessagePack/PINStreamingDecoding.h>
 
 @class PINBuffer;
+@class PINMessageUnpacker;
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ * The families of MessagePack types, for statistics.
+ */
+typedef NS_ENUM(NSUInteger, PINMessagePackType) {
+  PINMessagePackTypeNil,
+  PINMessagePackTypeBoolean,
+  PINMessagePackTypeInteger,
+  PINMessagePackTypeFloat,
+  PINMessagePackTypeString,
+  PINMessagePackTypeBinary,
+  PINMessagePackTypeArray,
+  PINMessagePackTypeMap,
+  PINMessagePackTypeExtension,
+  PINMessagePackTypeCount
+};
+
+/**
+ * Counters for an unpacker, collected when `collectsStatistics` is set.
+ */
+typedef struct {
+  /// Top-level values decoded.
+  uint64_t messageCount;
+  /// Values decoded as objects, by type. Values read by the primitive
+  /// decoders, and values that are skipped, aren't counted.
+  uint64_t objectCounts[PINMessagePackTypeCount];
+  /// The deepest nesting of arrays, maps and custom classes. A top-level scalar is depth 0.
+  uint64_t maximumDepth;
+  /// The most elements or pairs in one array or map.
+  uint64_t largestContainerCount;
+} PINDecodingStatistics;
+
+typedef NS_ENUM(uint8_t, PINMessageTraceEvent) {
+  PINMessageTraceEventBegin,
+  PINMessageTraceEventEnd
+};
+
+/**
+ * Called when an unpacker begins and ends decoding each top-level value,
+ * e.g. to emit signposts. Begin and end are called on the same thread,
+ * and the unpacker identifies the interval.
+ */
+typedef void (*PINMessageTraceFunction)(PINMessageTraceEvent event, PINMessageUnpacker *unpacker, void * _Nullable context);
+
+/**
+ * Routes message begin and end events from all unpackers to `function`.
+ *
+ * Set it once, before decoding starts. Pass NULL to turn tracing off.
+ * When off, which is the default, each message costs one load and branch.
+ */
+FOUNDATION_EXTERN void PINMessageUnpackerSetTraceFunction(PINMessageTraceFunction _Nullable function, void * _Nullable context);
+
+/**
+ * Creates an object from the payload of a MessagePack extension value.
+ *
+ * The bytes are only valid for the duration of the call. Return nil if
+ * the payload is invalid, and decoding will fail.
+ */
+typedef id _Nullable (^PINExtensionHandler)(int8_t type, const void *bytes, NSUInteger length);
+
+/**
+ * Classes that can be created from the payload of an extension value.
+ */
+@protocol PINExtensionDecoding <NSObject>
+
+/**
+ * Initialize from the payload. Return nil if it's invalid.
+ */
+- (nullable instancetype)initWithExtensionBytes:(const void *)bytes length:(NSUInteger)length;
+
+@end
+
 /**
  * Objects of this class are not thread-safe, and must be paired with a lock to
  * be accessed from multiple threads.
@@ -25,6 +97,65 @@ __attribute__((objc_subclassing_restricted))
  */
 - (instancetype)initWithBuffer:(PINBuffer *)buffer NS_DESIGNATED_INITIALIZER;
 
+/**
+ * Initialize an unpacker that reads directly from the given data.
+ *
+ * When the whole message is already in memory, this is much faster
+ * than writing it into a PINBuffer, since reads don't have to
+ * go through the buffer.
+ */
+- (instancetype)initWithData:(NSData *)data;
+
+/**
+ * Initialize an unpacker that reads directly from a memory-mapped file.
+ *
+ * Nothing is read up front or copied, so loading is bound by I/O. Like
+ * -initWithData:, this supports lazy and concurrent decoding. Pages stay
+ * resident while the unpacker is alive, though, so to decode a large file
+ * in bounded memory use -[PINBuffer initWithContentsOfFile:error:] instead.
+ *
+ * Returns nil if the file can't be opened or mapped. The file must not be
+ * truncated while the unpacker or anything it decoded without copying is alive.
+ */
+- (nullable instancetype)initWithContentsOfFile:(NSString *)path error:(NSError **)error;
+
+/**
+ * Initialize an unpacker that reads directly from the given bytes.
+ *
+ * The bytes are not copied, and must outlive the unpacker.
+ */
+- (instancetype)initWithBytes:(const void *)bytes length:(NSUInteger)length NS_DESIGNATED_INITIALIZER;
+
+/**
+ * Decode a stream of messages sent back to back, such as events on one connection.
+ *
+ * Each message is delivered as soon as its bytes have arrived, so parsing
+ * overlaps with receiving. Enumeration ends cleanly when the input ends at
+ * a message boundary, e.g. when the buffer completes. It also ends if a
+ * message fails to decode, in which case `error` is set.
+ *
+ * @param class The class of each message, as for -decodeObjectOfClass:.
+ * @param block Called with each message, which is nil for a nil message. Set `stop` to end early.
+ */
+- (void)enumerateMessagesOfClass:(nullable Class)class usingBlock:(void (^NS_NOESCAPE)(id _Nullable message, BOOL *stop))block;
+
+/**
+ * Decode only the values at the given key paths, skipping everything else.
+ *
+ * Paths are map keys separated by dots, and `[*]` selects every element
+ * of an array, e.g. `@[@"data.items[*].id", @"data.bookmark"]`. Values
+ * that aren't on a path are skipped without being decoded, and keys are
+ * matched without creating strings, so the cost scales with what you keep.
+ *
+ * The result has the same shape as the input, with only the selected keys.
+ * Maps that are on a path but contain none of its keys become empty.
+ * Array elements that don't match a path's shape become NSNull.
+ *
+ * @param class The expected class of the root: NSDictionary, NSArray or Nil.
+ * @param keyPaths The key paths to keep. Keys containing `.` or `[` can't be expressed.
+ */
+- (nullable id)decodeObjectOfClass:(nullable Class)class projectingKeyPaths:(NSArray<NSString *> *)keyPaths NS_RETURNS_RETAINED;
+
 /**
  * Ensure that all keys in maps are converted to strings.
  *
@@ -35,6 +166,118 @@ __attribute__((objc_subclassing_restricted))
  */
 @property BOOL forcesMapKeysToString;
 
+/**
+ * Reuse one string instance for each distinct map key.
+ *
+ * Useful when decoding many maps with the same keys, e.g. a long list
+ * of objects. Keys are matched by their UTF-8 bytes, so repeated keys
+ * cost a hash lookup instead of a new string. The number of interned
+ * strings is bounded.
+ *
+ * Defaults to NO.
+ */
+@property BOOL internsMapKeys;
+
+/**
+ * String values up to this many bytes long are also interned,
+ * e.g. enum-like values that repeat throughout a message.
+ *
+ * Defaults to 0, meaning values are not interned.
+ */
+@property NSUInteger maximumInternedValueLength;
+
+/**
+ * Return binary values as views into the input, instead of copies.
+ *
+ * Each value retains the chunk it was read from, or the whole data for
+ * unpackers created with -initWithData:. Values that span chunks are
+ * stitched together without flattening. This saves a copy of every binary
+ * value, but a small value will keep its whole chunk alive.
+ *
+ * Has no effect for unpackers created with -initWithBytes:length:, since
+ * the caller owns those bytes.
+ *
+ * Defaults to NO.
+ */
+@property BOOL decodesBinaryDataWithoutCopying;
+
+/**
+ * Decode arrays and maps lazily.
+ *
+ * Instead of decoding every element up front, the unpacker records where
+ * each one sits in the input and returns an array or dictionary that
+ * decodes elements the first time they're accessed. Map keys are still
+ * decoded up front. This is much faster when you only read a few values
+ * out of a large message. The collections retain the input, and are
+ * safe to read from multiple threads.
+ *
+ * Only applies to unpackers created with -initWithData:, or to unpackers
+ * whose buffer has completed by the time a collection is decoded. Arrays
+ * and maps decoded with an element class, and sets, are decoded eagerly.
+ *
+ * Lazy elements are found by offset, so the input must be contiguous. When
+ * a completed buffer holds more than one chunk, its remaining data is
+ * copied into one data up front. For the cheapest lazy decoding of large
+ * input, use -initWithData: or -initWithContentsOfFile:error:.
+ *
+ * Since values are decoded on access, after this unpacker has moved on,
+ * an invalid value isn't reported. It reads as NSNull.
+ *
+ * Defaults to NO.
+ */
+@property BOOL decodesLazily;
+
+/**
+ * The number of threads to decode large arrays with.
+ *
+ * When greater than 1, arrays with many elements are decoded concurrently:
+ * the unpacker finds where each element starts, then decodes stripes of
+ * elements on up to this many threads. The result is the same as decoding
+ * serially. This applies to arrays at any level, such as a top-level array
+ * or an array of items inside a map, but not inside the elements being
+ * decoded concurrently.
+ *
+ * Only applies to unpackers created with -initWithData: or -initWithBytes:length:.
+ * When `decodesLazily` is set, arrays are decoded lazily instead, and this
+ * has no effect.
+ *
+ * Extension handlers are called from all of those threads at once, so
+ * they must be thread-safe when this is greater than 1.
+ *
+ * Defaults to 1.
+ */
+@property NSUInteger decodingConcurrency;
+
+/**
+ * Decode extension values of the given type with the given handler.
+ *
+ * Extension types that aren't registered are invalid, except for the
+ * standard timestamp type (-1), which decodes to NSDate. Registering
+ * a handler for -1 replaces that.
+ */
+- (void)registerExtensionType:(int8_t)type handler:(PINExtensionHandler)handler;
+
+/**
+ * Decode extension values of the given type as instances of the given class.
+ */
+- (void)registerExtensionType:(int8_t)type class:(Class<PINExtensionDecoding>)class;
+
+/**
+ * Whether to collect statistics. Set this before decoding.
+ *
+ * Also turns on statistics for the buffer, if there is one.
+ *
+ * Defaults to NO, in which case the counters cost a branch at most.
+ */
+@property (nonatomic) BOOL collectsStatistics;
+
+/**
+ * A snapshot of the statistics so far. All zeros unless `collectsStatistics` is set.
+ *
+ * See the buffer's statistics for bytes, chunks, waiting and locking.
+ */
+@property (nonatomic, readonly) PINDecodingStatistics statistics;
+
 #pragma mark - Unavailable
 
 - (instancetype)init NS_UNAVAILABLE;
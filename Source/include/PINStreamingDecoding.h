@@ -11,6 +11,7 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @protocol PINStreamingDecoder;
+@class PINDecodingPlan;
 
 @protocol PINStreamingDecoding <NSObject>
 
@@ -24,6 +25,19 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+@protocol PINStreamingMerging <NSObject>
+
+/**
+ * Update this instance in place from the given streaming decoder. Decode
+ * exactly one value, e.g. with -decodeMapIntoObject:withPlan: on `self`.
+ *
+ * You do not call this method directly. It's called when merging into an
+ * object graph that contains this instance, with -decodeObjectMergingIntoObject:.
+ */
+- (void)mergeWithStreamingDecoder:(id<PINStreamingDecoder>)decoder;
+
+@end
+
 @protocol PINStreamingDecoder <NSObject>
 
 /**
@@ -39,6 +53,24 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)enumerateKeysInMapWithBlock:(void (^NS_NOESCAPE)(const char *key, NSUInteger keyLen))block;
 
+/**
+ * Decode a map straight into the ivars of an object, using a precompiled plan.
+ *
+ * A faster alternative to -enumerateKeysInMapWithBlock: for classes with
+ * many fields. Keys that aren't in the plan are skipped.
+ *
+ * @param object The object to decode into, typically `self`. Must be an instance of the plan's class.
+ * @param plan The plan, typically created once per class and stored in a static.
+ */
+- (void)decodeMapIntoObject:(id)object withPlan:(PINDecodingPlan *)plan;
+
+/**
+ * Skip the next value, including everything nested inside it.
+ *
+ * Useful for ignoring unknown keys in your -initWithStreamingDecoder implementation.
+ */
+- (void)skipValue;
+
 /**
  * Decode a boolean value.
  */
@@ -54,15 +86,115 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSInteger)decodeInteger;
 
+/**
+ * Decode an integer that fits in 32 bits.
+ */
+- (int32_t)decodeInt32;
+
+/**
+ * Decode a non-negative integer that fits in 32 bits.
+ */
+- (uint32_t)decodeUInt32;
+
+/**
+ * Decode an integer that fits in 64 bits, even on 32-bit platforms.
+ */
+- (int64_t)decodeInt64;
+
+/**
+ * Decode a non-negative integer, including values above INT64_MAX.
+ */
+- (uint64_t)decodeUInt64;
+
+/**
+ * Decode a floating point value as float. Doubles are narrowed.
+ */
+- (float)decodeFloat;
+
+/**
+ * Decode an integer, or nil.
+ *
+ * These optional variants accept nil without an error, and report
+ * whether there was a value through `present`. The return value
+ * is 0 when there wasn't.
+ */
+- (int64_t)decodeOptionalInt64:(BOOL *)present;
+
+/**
+ * Decode a non-negative integer, or nil. See -decodeOptionalInt64:.
+ */
+- (uint64_t)decodeOptionalUInt64:(BOOL *)present;
+
+/**
+ * Decode a floating point value as double, or nil. See -decodeOptionalInt64:.
+ */
+- (double)decodeOptionalDouble:(BOOL *)present;
+
+/**
+ * Decode a floating point value as float, or nil. See -decodeOptionalInt64:.
+ */
+- (float)decodeOptionalFloat:(BOOL *)present;
+
+/**
+ * Decode a boolean value, or nil. See -decodeOptionalInt64:.
+ */
+- (BOOL)decodeOptionalBOOL:(BOOL *)present;
+
+/**
+ * Decode an array of numbers into a buffer, without creating any objects.
+ *
+ * Elements may be encoded as any integer type. Runs of elements that share
+ * an encoding, e.g. all int32, are decoded in a tight loop straight from
+ * the input.
+ *
+ * @param values Room for at least `maxCount` values.
+ * @param maxCount The capacity of `values`. A longer array is an error.
+ * @return The number of values decoded.
+ */
+- (NSUInteger)decodeInt64Array:(int64_t *)values maxCount:(NSUInteger)maxCount;
+
+/**
+ * Decode an array of numbers into a buffer of doubles. Elements may be
+ * encoded as any integer or floating point type.
+ *
+ * See -decodeInt64Array:maxCount:.
+ */
+- (NSUInteger)decodeDoubleArray:(double *)values maxCount:(NSUInteger)maxCount;
+
+/**
+ * Decode an array of numbers into a buffer of floats. Elements may be
+ * encoded as any integer or floating point type.
+ *
+ * See -decodeInt64Array:maxCount:.
+ */
+- (NSUInteger)decodeFloatArray:(float *)values maxCount:(NSUInteger)maxCount;
+
+/**
+ * Decode an array of integers into data holding `int64_t` values.
+ */
+- (nullable NSData *)decodeInt64Array NS_RETURNS_RETAINED;
+
+/**
+ * Decode an array of numbers into data holding `double` values.
+ */
+- (nullable NSData *)decodeDoubleArray NS_RETURNS_RETAINED;
+
+/**
+ * Decode an array of numbers into data holding `float` values.
+ */
+- (nullable NSData *)decodeFloatArray NS_RETURNS_RETAINED;
+
 /**
  * Decode an object of the given class.
  *
  * For arrays, sets, and dictionaries you should prefer -decodeArray et al.
  *
  * Possible return types are NSNumber, NSString,
- * NSData, NSArray, NSDictionary, or the class you provide.
+ * NSData, NSArray, NSDictionary, NSDate for timestamps, objects
+ * from registered extension handlers, or the class you provide.
  *
- * Mutable collection types are not currently supported.
+ * Collections are immutable. To decode into mutable ones, see
+ * -decodeArrayOfClass:intoArray: and -decodeObjectMergingIntoObject:.
  *
  * NSNull will not be returned. Nils will be decoded as nil.
  */
@@ -93,6 +225,53 @@ NS_ASSUME_NONNULL_BEGIN
 - (nullable NSDictionary *)decodeDictionaryWithKeyClass:(nullable Class)keyClass
                                             objectClass:(nullable Class)objectClass NS_RETURNS_RETAINED;
 
+/**
+ * Decodes an array into an existing mutable array, replacing its contents.
+ *
+ * Elements are replaced in place and the array is only grown or trimmed
+ * at the end, so its storage is reused when the count stays about the same.
+ *
+ * @param class The class of elements. Nils are decoded as NSNull.
+ * @return NO if the value isn't an array or decoding failed. The array may be partly updated.
+ */
+- (BOOL)decodeArrayOfClass:(nullable Class)class intoArray:(NSMutableArray *)array;
+
+/**
+ * Decodes a dictionary into an existing mutable dictionary, replacing its contents.
+ *
+ * Existing keys are updated in place. Keys that aren't in the encoded map
+ * are removed afterward, which is free when the set of keys is unchanged.
+ *
+ * @return NO if the value isn't a map or decoding failed. The dictionary may be partly updated.
+ */
+- (BOOL)decodeDictionaryWithKeyClass:(nullable Class)keyClass
+                         objectClass:(nullable Class)objectClass
+                      intoDictionary:(NSMutableDictionary *)dictionary;
+
+/**
+ * Decodes a value by merging it into an existing object graph, updating it in place.
+ *
+ * - A map merges into an NSMutableDictionary: the value for each encoded
+ *   key is merged into the existing value for that key. Keys that aren't
+ *   in the map are kept.
+ * - An array merges into an NSMutableArray element by element, and the
+ *   array is trimmed to the encoded count.
+ * - Any value merges into an object that conforms to PINStreamingMerging,
+ *   which updates itself.
+ * - Anything else decodes a new value, like -decodeObjectOfClass: with Nil.
+ *
+ * Arrays and maps that the merge creates are mutable, so a graph that
+ * starts out from nil, or from empty mutable containers, can be merged
+ * into again and again, e.g. when polling. Immutable arrays and maps,
+ * such as those from -decodeObjectOfClass:, are copied and the copy is
+ * merged into and returned in their place. After one merge the whole
+ * graph is mutable.
+ *
+ * @param object The existing value, or nil.
+ * @return `object` if it was updated in place, otherwise the new value. Nil for nil or on error.
+ */
+- (nullable id)decodeObjectMergingIntoObject:(nullable id)object NS_RETURNS_RETAINED;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,90 @@
+//
+//  PINStreamingEncoding.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol PINStreamingEncoder;
+
+@protocol PINStreamingEncoding <NSObject>
+
+/**
+ * Write this instance into the given streaming encoder.
+ *
+ * You do not call this method directly. Instead, create an encoder and call
+ * -encodeObject: on it.
+ *
+ * Typically you will write a map header with -encodeMapHeaderWithCount:
+ * and then alternate -encodeKey:length: with the value for that key, which
+ * can be read back with -[PINStreamingDecoder enumerateKeysInMapWithBlock:].
+ */
+- (void)encodeWithStreamingEncoder:(id<PINStreamingEncoder>)encoder;
+
+@end
+
+@protocol PINStreamingEncoder <NSObject>
+
+/**
+ * The most recent error that occurred during encoding, if any.
+ */
+@property (nonatomic, nullable, copy, readonly) NSError *error;
+
+/**
+ * Begin a map with `count` key-value pairs.
+ *
+ * The next `count * 2` values you encode will be its keys and values.
+ */
+- (void)encodeMapHeaderWithCount:(NSUInteger)count;
+
+/**
+ * Begin an array with `count` elements.
+ *
+ * The next `count` values you encode will be its elements.
+ */
+- (void)encodeArrayHeaderWithCount:(NSUInteger)count;
+
+/**
+ * A fast way to write a UTF-8 string map key, without creating an NSString.
+ */
+- (void)encodeKey:(const char *)key length:(NSUInteger)keyLen;
+
+/**
+ * Encode a nil.
+ */
+- (void)encodeNil;
+
+/**
+ * Encode a boolean value.
+ */
+- (void)encodeBOOL:(BOOL)value;
+
+/**
+ * Encode a floating point value as double.
+ */
+- (void)encodeDouble:(double)value;
+
+/**
+ * Encode an integer, using the smallest representation that fits.
+ */
+- (void)encodeInteger:(NSInteger)value;
+
+/**
+ * Encode an object.
+ *
+ * Supported types are NSNull, NSNumber, NSString, NSData, NSDate, NSArray, NSSet,
+ * NSDictionary, or any class that conforms to PINStreamingEncoding.
+ *
+ * Sets are encoded as arrays. Dates are encoded as timestamp extension values,
+ * to the nearest nanosecond. Nil is encoded as nil.
+ */
+- (void)encodeObject:(nullable id)object;
+
+@end
+
+NS_ASSUME_NONNULL_END
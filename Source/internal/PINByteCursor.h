@@ -0,0 +1,70 @@
+//
+//  PINByteCursor.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * A read position in a contiguous range of bytes.
+ *
+ * Used for decoding when the whole message is already in memory, so that
+ * reads are a bounds check and a memcpy instead of a trip through PINBuffer.
+ */
+typedef struct {
+  const uint8_t *bytes;
+  size_t length;
+  size_t offset;
+} PINByteCursor;
+
+NS_INLINE PINByteCursor PINByteCursorMake(const void *bytes, size_t length)
+{
+  return (PINByteCursor){ (const uint8_t *)bytes, length, 0 };
+}
+
+NS_INLINE size_t PINByteCursorRemaining(const PINByteCursor *cursor)
+{
+  return cursor->length - cursor->offset;
+}
+
+/**
+ * Copies `count` bytes out and advances. Returns false without advancing
+ * if there are not enough bytes left.
+ */
+NS_INLINE bool PINByteCursorRead(PINByteCursor *cursor, void *data, size_t count)
+{
+  if (count > PINByteCursorRemaining(cursor)) {
+    return false;
+  }
+  memcpy(data, cursor->bytes + cursor->offset, count);
+  cursor->offset += count;
+  return true;
+}
+
+/**
+ * Advances `count` bytes. Returns false without advancing if there are
+ * not enough bytes left.
+ */
+NS_INLINE bool PINByteCursorSkip(PINByteCursor *cursor, size_t count)
+{
+  if (count > PINByteCursorRemaining(cursor)) {
+    return false;
+  }
+  cursor->offset += count;
+  return true;
+}
+
+/**
+ * Returns a pointer to the next `count` bytes without advancing, or NULL
+ * if there are not enough bytes left.
+ */
+NS_INLINE const void *PINByteCursorPeek(const PINByteCursor *cursor, size_t count)
+{
+  if (count > PINByteCursorRemaining(cursor)) {
+    return NULL;
+  }
+  return cursor->bytes + cursor->offset;
+}
@@ -0,0 +1,42 @@
+//
+//  PINDecodingPlanField.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "PINDecodingPlan.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(uint8_t, PINDecodingFieldKind) {
+  PINDecodingFieldKindSigned,
+  PINDecodingFieldKindUnsigned,
+  PINDecodingFieldKindBool,
+  PINDecodingFieldKindFloat,
+  PINDecodingFieldKindDouble,
+  PINDecodingFieldKindObject
+};
+
+/**
+ * One compiled field of a plan.
+ */
+typedef struct {
+  const char *key;
+  uint32_t keyLength;
+  PINDecodingFieldKind kind;
+  // The size of integer fields, in bytes.
+  uint8_t size;
+  ptrdiff_t offset;
+  __unsafe_unretained Class _Nullable class;
+} PINDecodingPlanField;
+
+/**
+ * Finds the field for a key, given its UTF-8 bytes, or returns NULL if the
+ * plan doesn't have the key.
+ */
+const PINDecodingPlanField * _Nullable PINDecodingPlanGetField(PINDecodingPlan *plan, const char *key, size_t keyLength);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,55 @@
+//
+//  PINKeyPathProjection.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A tree of key paths to decode, where everything else is skipped.
+ *
+ * Paths are map keys separated by dots, and `[*]` selects every element
+ * of an array, e.g. `data.items[*].id`. A path may start with `[*]` if
+ * the root is an array. Keys containing `.` or `[` can't be expressed.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface PINKeyPathProjection : NSObject
+
+/**
+ * Parses the given key paths, or returns nil if any of them is malformed.
+ */
++ (nullable instancetype)projectionWithKeyPaths:(NSArray<NSString *> *)keyPaths;
+
+/**
+ * Whether a path ends here, so the whole value should be kept.
+ */
+@property (nonatomic, readonly) BOOL keepsValue;
+
+/**
+ * Whether any paths continue into map keys.
+ */
+@property (nonatomic, readonly) BOOL hasChildren;
+
+/**
+ * The projection for each element of an array, if a path continues with `[*]`.
+ */
+@property (nonatomic, nullable, readonly) PINKeyPathProjection *elementProjection;
+
+/**
+ * Finds the child for a map key, given its UTF-8 bytes.
+ *
+ * Matching is done on the bytes, so keys that aren't selected never become strings.
+ * On a match, `outKey` is set to the key.
+ */
+- (nullable PINKeyPathProjection *)childForKeyBytes:(const char *)bytes
+                                             length:(NSUInteger)length
+                                                key:(NSString * _Nullable __autoreleasing * _Nonnull)outKey;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,103 @@
+//
+//  PINLazyCollections.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * The unpacker options that lazy collections carry, so that their
+ * elements are decoded the same way as the rest of the message.
+ */
+typedef struct {
+  BOOL forcesMapKeysToString;
+  BOOL internsMapKeys;
+  BOOL decodesBinaryDataWithoutCopying;
+  NSUInteger maximumInternedValueLength;
+  // Retained by the context that carries the options.
+  __unsafe_unretained NSDictionary * _Nullable extensionHandlers;
+} PINLazyDecodingOptions;
+
+@class PINMessageUnpacker;
+
+/**
+ * Decodes the elements of the lazy collections from one message.
+ *
+ * The collections share one unpacker, so its scratch space and intern
+ * table are reused rather than created for every element. One thread uses
+ * it at a time. Others, and extension handlers that read a collection while
+ * an element is being decoded, use a temporary unpacker rather than wait.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface PINLazyDecodingContext : NSObject
+
+- (instancetype)initWithData:(NSData *)data options:(PINLazyDecodingOptions)options;
+
+@property (nonatomic, readonly) NSData *data;
+@property (nonatomic, readonly) PINLazyDecodingOptions options;
+
+/**
+ * Decodes the value at `offset`. An invalid value decodes as NSNull,
+ * since collections can't hold nil, and isn't reported.
+ */
+- (id)decodeObjectAtOffset:(NSUInteger)offset NS_RETURNS_RETAINED;
+
+@end
+
+/**
+ * Creates an unpacker for a context's elements. Implemented by PINMessageUnpacker.
+ */
+FOUNDATION_EXTERN PINMessageUnpacker *PINLazyUnpackerCreate(PINLazyDecodingContext *context) NS_RETURNS_RETAINED;
+
+/**
+ * Decodes the value at `offset` with an unpacker from PINLazyUnpackerCreate.
+ * Implemented by PINMessageUnpacker.
+ *
+ * Returns nil if the value is invalid.
+ */
+FOUNDATION_EXTERN id _Nullable PINLazyUnpackerDecodeObject(PINMessageUnpacker *unpacker, NSUInteger offset) NS_RETURNS_RETAINED;
+
+/**
+ * An array that records where each element sits in the encoded data,
+ * and decodes it on first access.
+ *
+ * Elements are decoded at most once, and access is thread-safe.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface PINLazyArray : NSArray
+
+/**
+ * Takes ownership of `offsets`, which must come from malloc.
+ */
+- (instancetype)initWithContext:(PINLazyDecodingContext *)context
+                        offsets:(NSUInteger *)offsets
+                          count:(NSUInteger)count;
+
+@end
+
+/**
+ * A dictionary with eagerly-decoded keys, that decodes each
+ * value on first access.
+ *
+ * Values are decoded at most once, and access is thread-safe.
+ */
+__attribute__((objc_subclassing_restricted))
+@interface PINLazyDictionary : NSDictionary
+
+/**
+ * Takes ownership of `offsets`, which must come from malloc, and
+ * transfers the +1 on each key.
+ */
+- (instancetype)initWithContext:(PINLazyDecodingContext *)context
+                   retainedKeys:(CFTypeRef _Nonnull [_Nonnull])keys
+                        offsets:(NSUInteger *)offsets
+                          count:(NSUInteger)count;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,36 @@
+//
+//  PINMappedFile.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class PINBuffer;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The chunk length for buffers read from files. A multiple of any page size.
+static const NSUInteger kPINMappedFileChunkLength = 1024 * 1024;
+
+/**
+ * Maps a file read-only, with a sequential access hint, and returns the
+ * mapping as one data. The file is unmapped when the data is deallocated.
+ *
+ * The file must not be truncated while it's mapped.
+ */
+FOUNDATION_EXTERN NSData * _Nullable PINMappedFileCreateData(NSString *path, NSError **error) NS_RETURNS_RETAINED;
+
+/**
+ * Maps a file read-only and writes it into `buffer` in chunks of `chunkLength`,
+ * which must be a multiple of the page size. Doesn't close the buffer.
+ *
+ * When a chunk is deallocated, its pages are given back to the kernel, so
+ * the resident size follows the reader instead of growing to the whole file.
+ * The file is unmapped when the last chunk is deallocated.
+ */
+FOUNDATION_EXTERN BOOL PINMappedFileWriteToBuffer(NSString *path, PINBuffer *buffer, NSUInteger chunkLength, NSError **error);
+
+NS_ASSUME_NONNULL_END
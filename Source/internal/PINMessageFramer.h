@@ -0,0 +1,50 @@
+//
+//  PINMessageFramer.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Finds where MessagePack messages end in a stream of chunks, without
+ * decoding them.
+ *
+ * All the state is in the struct, so scanning can stop at the end of any
+ * chunk, in the middle of a header or payload, and pick up again with the
+ * next one. Zero-initialize it to start.
+ */
+typedef struct {
+  // Values still needed to finish the current message, or 0 between messages.
+  uint64_t pending;
+  // Bytes of str, bin or ext payload still to pass over.
+  uint64_t payloadRemaining;
+  // The header being read, which may be split across chunks.
+  uint8_t header[9];
+  uint8_t headerLength;
+  uint8_t headerNeeded;
+  // Set if the stream contains an invalid marker.
+  bool failed;
+} PINMessageFramer;
+
+/**
+ * Scans forward until the end of the current message, or the end of the bytes.
+ *
+ * @param complete Set to whether a message ended at the returned position.
+ * @return The number of bytes scanned.
+ */
+size_t PINMessageFramerScan(PINMessageFramer *framer, const uint8_t *bytes, size_t length, bool *complete);
+
+/**
+ * Whether the framer is between messages.
+ */
+NS_INLINE bool PINMessageFramerIsAtBoundary(const PINMessageFramer *framer)
+{
+  return (framer->pending == 0 && framer->payloadRemaining == 0 && framer->headerLength == 0);
+}
+
+NS_ASSUME_NONNULL_END
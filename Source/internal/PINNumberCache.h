@@ -0,0 +1,44 @@
+//
+//  PINNumberCache.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The range of integers that have a shared number: every fixnum, plus uint8.
+enum {
+  kPINNumberCacheMin = -32,
+  kPINNumberCacheMax = 255
+};
+
+/**
+ * The shared numbers, indexed by value minus kPINNumberCacheMin. They are
+ * created once per process and never released.
+ */
+FOUNDATION_EXTERN const CFNumberRef _Nonnull * _Nonnull PINNumberCacheGetNumbers(void);
+
+/**
+ * Creates a number for an integer, or retains the shared one if the value is small.
+ * Shared numbers keep their own type, so `type` only applies to new ones.
+ *
+ * Booleans don't need this, since kCFBooleanTrue and kCFBooleanFalse are
+ * already shared.
+ *
+ * @param value The value, for the cache lookup.
+ * @param type The type to create the number with, if it isn't cached.
+ * @param valuePtr The value as `type`.
+ */
+NS_INLINE CFNumberRef PINNumberCreateWithInteger(int64_t value, CFNumberType type, const void *valuePtr)
+{
+  if (value >= kPINNumberCacheMin && value <= kPINNumberCacheMax) {
+    return (CFNumberRef)CFRetain(PINNumberCacheGetNumbers()[value - kPINNumberCacheMin]);
+  }
+  return CFNumberCreate(NULL, type, valuePtr);
+}
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,71 @@
+//
+//  PINNumberFormatting.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Room for any number formatted below, including the sign. Not terminated.
+enum {
+  kPINNumberFormatBufferLength = 32
+};
+
+/**
+ * Writes the decimal digits of an integer, two at a time. Returns the length.
+ */
+FOUNDATION_EXTERN size_t PINFormatUInt64(uint64_t value, char *buffer);
+FOUNDATION_EXTERN size_t PINFormatInt64(int64_t value, char *buffer);
+
+/**
+ * Writes the shortest decimal that reads back as the same value, using
+ * Grisu2. Returns the length.
+ *
+ * The output follows JavaScript: "2", "0.1", "-0.000001", and exponents
+ * below 1e-6 and from 1e21 up, like "1.5e-7" and "1e+21". Also "nan",
+ * "inf" and "-inf". Grisu2 very rarely gives one more digit than the
+ * shortest, but the result always round-trips.
+ */
+FOUNDATION_EXTERN size_t PINFormatDouble(double value, char *buffer);
+
+/**
+ * Like PINFormatDouble, but for the shortest decimal that reads back as
+ * the same float, e.g. "0.1" for 0.1f rather than "0.100000001490116".
+ */
+FOUNDATION_EXTERN size_t PINFormatFloat(float value, char *buffer);
+
+/// Creates a string from formatted number bytes, which are always ASCII.
+NS_INLINE CFStringRef PINStringCreateWithFormattedNumber(const char *buffer, size_t length)
+{
+  return CFStringCreateWithBytes(NULL, (const UInt8 *)buffer, (CFIndex)length, kCFStringEncodingASCII, false);
+}
+
+NS_INLINE CFStringRef PINStringCreateWithInt64(int64_t value)
+{
+  char buffer[kPINNumberFormatBufferLength];
+  return PINStringCreateWithFormattedNumber(buffer, PINFormatInt64(value, buffer));
+}
+
+NS_INLINE CFStringRef PINStringCreateWithUInt64(uint64_t value)
+{
+  char buffer[kPINNumberFormatBufferLength];
+  return PINStringCreateWithFormattedNumber(buffer, PINFormatUInt64(value, buffer));
+}
+
+NS_INLINE CFStringRef PINStringCreateWithDouble(double value)
+{
+  char buffer[kPINNumberFormatBufferLength];
+  return PINStringCreateWithFormattedNumber(buffer, PINFormatDouble(value, buffer));
+}
+
+NS_INLINE CFStringRef PINStringCreateWithFloat(float value)
+{
+  char buffer[kPINNumberFormatBufferLength];
+  return PINStringCreateWithFormattedNumber(buffer, PINFormatFloat(value, buffer));
+}
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,56 @@
+//
+//  PINNumericArrays.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "cmp.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * The primitive types that numeric arrays can be decoded into.
+ */
+typedef NS_ENUM(uint8_t, PINNumericType) {
+  PINNumericTypeInt64,
+  PINNumericTypeDouble,
+  PINNumericTypeFloat
+};
+
+NS_INLINE size_t PINNumericTypeSize(PINNumericType type)
+{
+  switch (type) {
+    case PINNumericTypeInt64:
+      return sizeof(int64_t);
+    case PINNumericTypeDouble:
+      return sizeof(double);
+    case PINNumericTypeFloat:
+      return sizeof(float);
+  }
+  return 0;
+}
+
+/**
+ * Decodes a run of numbers that share one encoding, e.g. all int32 or all
+ * float64, straight out of contiguous MessagePack bytes.
+ *
+ * Stops at the first element encoded differently, when the bytes run out,
+ * or after `maxCount` elements. Elements that don't fit the type, such as
+ * floats into int64, also stop the run.
+ *
+ * @param consumed On return, the number of bytes decoded.
+ * @return The number of values written.
+ */
+NSUInteger PINNumericArrayDecodeRun(const uint8_t *bytes, size_t length, PINNumericType type, void *values, NSUInteger maxCount, size_t *consumed);
+
+/**
+ * Stores a number read by cmp at `values[index]`.
+ *
+ * Returns false if it isn't a number or doesn't fit the type.
+ */
+bool PINNumericArrayStoreObject(const cmp_object_t *object, PINNumericType type, void *values, NSUInteger index);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,71 @@
+//
+//  PINScratch.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef struct PINScratchBlock PINScratchBlock;
+
+/**
+ * A stack of scratch memory, for temporary storage whose size comes off the wire.
+ *
+ * Allocations are released in LIFO order by resetting to a mark. Memory
+ * comes from a chain of blocks that are kept after use, so allocations
+ * never move while outer levels hold them, and repeated decodes don't
+ * have to malloc.
+ *
+ * Zero-initialize to create. Not thread-safe.
+ */
+typedef struct {
+  PINScratchBlock * _Nullable first;
+  PINScratchBlock * _Nullable current;
+} PINScratch;
+
+typedef struct {
+  PINScratchBlock * _Nullable block;
+  size_t used;
+} PINScratchMark;
+
+/**
+ * Returns `size` bytes of pointer-aligned memory, valid until the scratch
+ * is reset to a mark taken before this call. Returns NULL if the memory
+ * couldn't be allocated.
+ */
+void * _Nullable PINScratchAlloc(PINScratch *scratch, size_t size);
+
+/**
+ * Frees all blocks.
+ */
+void PINScratchDestroy(PINScratch *scratch);
+
+struct PINScratchBlock {
+  PINScratchBlock * _Nullable next;
+  size_t size;
+  size_t used;
+  uint8_t data[];
+};
+
+NS_INLINE PINScratchMark PINScratchGetMark(PINScratch *scratch)
+{
+  PINScratchBlock *block = scratch->current;
+  return (PINScratchMark){ block, (block ? block->used : 0) };
+}
+
+/**
+ * Releases everything allocated since the mark was taken.
+ */
+NS_INLINE void PINScratchReset(PINScratch *scratch, PINScratchMark mark)
+{
+  scratch->current = mark.block;
+  if (mark.block) {
+    mark.block->used = mark.used;
+  }
+}
+
+NS_ASSUME_NONNULL_END
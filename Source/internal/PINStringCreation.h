@@ -0,0 +1,68 @@
+//
+//  PINStringCreation.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#import <arm_neon.h>
+#elif defined(__SSE2__)
+#import <emmintrin.h>
+#endif
+
+/**
+ * Whether all the bytes are 7-bit ASCII. Checks 16 bytes at a time with
+ * NEON or SSE2 where available, and 8 at a time otherwise.
+ */
+NS_INLINE bool PINBytesAreASCII(const void *bytes, size_t length)
+{
+  const uint8_t *p = (const uint8_t *)bytes;
+  const uint8_t *end = p + length;
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+  uint8x16_t acc = vdupq_n_u8(0);
+  for (; end - p >= 16; p += 16) {
+    acc = vorrq_u8(acc, vld1q_u8(p));
+  }
+  if (vmaxvq_u8(acc) >= 0x80) {
+    return false;
+  }
+#elif defined(__SSE2__)
+  __m128i acc = _mm_setzero_si128();
+  for (; end - p >= 16; p += 16) {
+    acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i *)(const void *)p));
+  }
+  if (_mm_movemask_epi8(acc) != 0) {
+    return false;
+  }
+#endif
+
+  uint64_t word = 0;
+  for (; end - p >= 8; p += 8) {
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    word |= w;
+  }
+  uint8_t tail = 0;
+  for (; p < end; p++) {
+    tail |= *p;
+  }
+  return ((word & 0x8080808080808080ULL) == 0 && tail < 0x80);
+}
+
+/**
+ * Creates a string from UTF-8 bytes, taking the cheap ASCII route if possible.
+ *
+ * ASCII strings are stored as 8-bit by CF either way, but with the ASCII
+ * encoding it can copy them without decoding. Everything else is validated
+ * and transcoded by CF, as before. Returns NULL if the bytes are not valid UTF-8.
+ */
+NS_INLINE CFStringRef PINStringCreateWithUTF8Bytes(const void *bytes, size_t length)
+{
+  const CFStringEncoding encoding = (PINBytesAreASCII(bytes, length) ? kCFStringEncodingASCII : kCFStringEncodingUTF8);
+  return CFStringCreateWithBytes(NULL, (const UInt8 *)bytes, (CFIndex)length, encoding, false);
+}
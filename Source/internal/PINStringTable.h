@@ -0,0 +1,39 @@
+//
+//  PINStringTable.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A bounded table of immutable strings, keyed by their UTF-8 bytes.
+ *
+ * Used to share one string instance between repeated map keys. Not thread-safe.
+ */
+typedef struct PINStringTable PINStringTable;
+
+/**
+ * Create a table that holds at most `maxCount` strings.
+ */
+PINStringTable *PINStringTableCreate(NSUInteger maxCount);
+
+void PINStringTableDestroy(PINStringTable *table);
+
+/**
+ * Returns the string interned for these bytes, or NULL. The result is not retained.
+ */
+CFStringRef _Nullable PINStringTableGet(PINStringTable *table, const void *bytes, size_t length);
+
+/**
+ * Intern a string for these bytes. The table retains the string and copies the bytes.
+ *
+ * Does nothing if the table is full.
+ */
+void PINStringTableAdd(PINStringTable *table, const void *bytes, size_t length, CFStringRef string);
+
+NS_ASSUME_NONNULL_END
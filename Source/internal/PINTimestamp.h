@@ -0,0 +1,113 @@
+//
+//  PINTimestamp.h
+//  PINMessagePack
+//
+//  Created by Adlai on 10/17/26.
+//  Copyright © 2026 Pinterest. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/// The extension type of the standard MessagePack timestamp.
+static const int8_t kPINTimestampExtensionType = -1;
+
+/// Seconds from the Unix epoch to the CF reference date, as an integer so that
+/// we can rebase before converting to floating point.
+static const int64_t kPINUnixToAbsoluteTimeSeconds = 978307200;
+
+NS_INLINE uint32_t PINTimestampReadBig32(const uint8_t *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+NS_INLINE void PINTimestampWriteBig32(uint8_t *p, uint32_t v)
+{
+  p[0] = (uint8_t)(v >> 24);
+  p[1] = (uint8_t)(v >> 16);
+  p[2] = (uint8_t)(v >> 8);
+  p[3] = (uint8_t)v;
+}
+
+/**
+ * Reads a timestamp 32, 64 or 96 payload into Unix seconds and nanoseconds.
+ *
+ * Returns false if the length is wrong or the nanoseconds are out of range.
+ */
+NS_INLINE bool PINTimestampDecode(const uint8_t *bytes, size_t length, int64_t *seconds, uint32_t *nanoseconds)
+{
+  switch (length) {
+    case 4:
+      *seconds = PINTimestampReadBig32(bytes);
+      *nanoseconds = 0;
+      return true;
+    case 8: {
+      // 30 bits of nanoseconds, then 34 bits of seconds.
+      const uint64_t v = ((uint64_t)PINTimestampReadBig32(bytes) << 32) | PINTimestampReadBig32(bytes + 4);
+      *seconds = (int64_t)(v & 0x3ffffffffULL);
+      *nanoseconds = (uint32_t)(v >> 34);
+      return *nanoseconds < 1000000000;
+    }
+    case 12:
+      *nanoseconds = PINTimestampReadBig32(bytes);
+      *seconds = (int64_t)(((uint64_t)PINTimestampReadBig32(bytes + 4) << 32) | PINTimestampReadBig32(bytes + 8));
+      return *nanoseconds < 1000000000;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Writes the smallest timestamp payload that holds the given time.
+ *
+ * @param bytes At least 12 bytes.
+ * @return The payload length: 4, 8 or 12.
+ */
+NS_INLINE size_t PINTimestampEncode(int64_t seconds, uint32_t nanoseconds, uint8_t *bytes)
+{
+  if ((seconds >> 34) == 0) {
+    const uint64_t v = ((uint64_t)nanoseconds << 34) | (uint64_t)seconds;
+    if ((v >> 32) == 0) {
+      PINTimestampWriteBig32(bytes, (uint32_t)v);
+      return 4;
+    }
+    PINTimestampWriteBig32(bytes, (uint32_t)(v >> 32));
+    PINTimestampWriteBig32(bytes + 4, (uint32_t)v);
+    return 8;
+  }
+  PINTimestampWriteBig32(bytes, nanoseconds);
+  PINTimestampWriteBig32(bytes + 4, (uint32_t)((uint64_t)seconds >> 32));
+  PINTimestampWriteBig32(bytes + 8, (uint32_t)seconds);
+  return 12;
+}
+
+/**
+ * Splits an absolute time into Unix seconds and nanoseconds, rounded to the
+ * nearest nanosecond.
+ *
+ * Returns false if the time can't be represented, e.g. it's infinite.
+ */
+NS_INLINE bool PINTimestampFromAbsoluteTime(CFAbsoluteTime time, int64_t *seconds, uint32_t *nanoseconds)
+{
+  // Leaves room for rebasing to the Unix epoch.
+  if (!(time > -9.0e18 && time < 9.0e18)) {
+    return false;
+  }
+  const double whole = floor(time);
+  int64_t s = (int64_t)whole;
+  int64_t ns = (int64_t)llround((time - whole) * 1e9);
+  if (ns >= 1000000000) {
+    s += 1;
+    ns -= 1000000000;
+  }
+  *seconds = s + kPINUnixToAbsoluteTimeSeconds;
+  *nanoseconds = (uint32_t)ns;
+  return true;
+}
+
+NS_INLINE CFAbsoluteTime PINTimestampGetAbsoluteTime(int64_t seconds, uint32_t nanoseconds)
+{
+  if (seconds < INT64_MIN + kPINUnixToAbsoluteTimeSeconds) {
+    return (CFAbsoluteTime)seconds - kPINUnixToAbsoluteTimeSeconds;
+  }
+  return (CFAbsoluteTime)(seconds - kPINUnixToAbsoluteTimeSeconds) + nanoseconds * 1e-9;
+}
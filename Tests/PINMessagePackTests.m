@@ -17,12 +17,163 @@ static size_t stream_writer(cmp_ctx_t *ctx, const void *data, size_t count)
   return count;
 }
 
+@interface PINTestPoint : NSObject <PINStreamingEncoding, PINStreamingDecoding>
+@property (nonatomic) NSInteger x;
+@property (nonatomic) double y;
+@property (nonatomic, copy) NSString *name;
+@end
+
+@implementation PINTestPoint
+
+- (instancetype)initWithStreamingDecoder:(id<PINStreamingDecoder>)decoder
+{
+  if (self = [super init]) {
+    [decoder enumerateKeysInMapWithBlock:^(const char *key, NSUInteger keyLen) {
+      if (strncmp(key, "x", keyLen) == 0) {
+        self->_x = [decoder decodeInteger];
+      } else if (strncmp(key, "y", keyLen) == 0) {
+        self->_y = [decoder decodeDouble];
+      } else if (strncmp(key, "name", keyLen) == 0) {
+        self->_name = [decoder decodeObjectOfClass:[NSString class]];
+      }
+    }];
+  }
+  return self;
+}
+
+- (void)encodeWithStreamingEncoder:(id<PINStreamingEncoder>)encoder
+{
+  [encoder encodeMapHeaderWithCount:3];
+  [encoder encodeKey:"x" length:1];
+  [encoder encodeInteger:_x];
+  [encoder encodeKey:"y" length:1];
+  [encoder encodeDouble:_y];
+  [encoder encodeKey:"name" length:4];
+  [encoder encodeObject:_name];
+}
+
+@end
+
+@interface PINTestMergeablePoint : PINTestPoint <PINStreamingMerging>
+@end
+
+@implementation PINTestMergeablePoint
+
+- (void)mergeWithStreamingDecoder:(id<PINStreamingDecoder>)decoder
+{
+  [decoder enumerateKeysInMapWithBlock:^(const char *key, NSUInteger keyLen) {
+    if (strncmp(key, "x", keyLen) == 0) {
+      self.x = [decoder decodeInteger];
+    } else if (strncmp(key, "y", keyLen) == 0) {
+      self.y = [decoder decodeDouble];
+    } else {
+      [decoder skipValue];
+    }
+  }];
+}
+
+@end
+
+@interface PINTestPlannedUser : NSObject <PINStreamingDecoding>
+@end
+
+@implementation PINTestPlannedUser {
+@public
+  int64_t _identifier;
+  uint8_t _age;
+  BOOL _verified;
+  float _score;
+  NSString *_name;
+  PINTestPoint *_location;
+}
+
++ (PINDecodingPlan *)decodingPlan
+{
+  static PINDecodingPlan *plan;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    plan = [[PINDecodingPlan alloc] initWithClass:self
+                                     ivarsForKeys:@{ @"id": @"_identifier",
+                                                     @"age": @"_age",
+                                                     @"verified": @"_verified",
+                                                     @"score": @"_score",
+                                                     @"name": @"_name",
+                                                     @"location": @"_location" }
+                                   classesForKeys:@{ @"name": [NSString class],
+                                                     @"location": [PINTestPoint class] }];
+  });
+  return plan;
+}
+
+- (instancetype)initWithStreamingDecoder:(id<PINStreamingDecoder>)decoder
+{
+  if (self = [super init]) {
+    [decoder decodeMapIntoObject:self withPlan:[PINTestPlannedUser decodingPlan]];
+  }
+  return self;
+}
+
+@end
+
+@interface PINTestWeakReferrer : NSObject {
+@public
+  __weak id _target;
+  NSString *_name;
+}
+@end
+
+@implementation PINTestWeakReferrer
+@end
+
+@interface PINTestIdentifier : NSObject <PINExtensionDecoding>
+@property (nonatomic, readonly) NSUUID *UUID;
+@end
+
+@implementation PINTestIdentifier
+
+- (instancetype)initWithExtensionBytes:(const void *)bytes length:(NSUInteger)length
+{
+  if (length != sizeof(uuid_t)) {
+    return nil;
+  }
+  if (self = [super init]) {
+    _UUID = [[NSUUID alloc] initWithUUIDBytes:bytes];
+  }
+  return self;
+}
+
+@end
+
+/// Counts assertion failures instead of raising, so tests can reach the
+/// error paths that assert in debug builds.
+@interface PINTestAssertionHandler : NSAssertionHandler
+@end
+
+@implementation PINTestAssertionHandler
+
+- (void)handleFailureInMethod:(SEL)selector object:(id)object file:(NSString *)fileName lineNumber:(NSInteger)line description:(NSString *)format, ...
+{
+}
+
+- (void)handleFailureInFunction:(NSString *)functionName file:(NSString *)fileName lineNumber:(NSInteger)line description:(NSString *)format, ...
+{
+}
+
+@end
+
+static void PINTestCountTraceEvents(PINMessageTraceEvent event, PINMessageUnpacker *unpacker, void *context)
+{
+  NSUInteger *counts = context;
+  counts[event]++;
+}
+
 @interface PINMessagePackTests : XCTestCase
 
 @end
 
 @implementation PINMessagePackTests {
   cmp_ctx_t writeCtx;
+  PINBuffer *writeBuffer;
   PINMessageUnpacker *u;
   NSOutputStream *outputStream;
 }
@@ -31,6 +182,7 @@ static size_t stream_writer(cmp_ctx_t *ctx, const void *data, size_t count)
   [super setUp];
   PINBuffer *buffer = [[PINBuffer alloc] init];
   cmp_init(&writeCtx, (__bridge void *)buffer, NULL, NULL, stream_writer);
+  writeBuffer = buffer;
   // Create reader
   u = [[PINMessageUnpacker alloc] initWithBuffer:buffer];
 }
@@ -40,6 +192,16 @@ static size_t stream_writer(cmp_ctx_t *ctx, const void *data, size_t count)
   [super tearDown];
 }
 
+/// Runs a block that is expected to fail, without raising on the
+/// assertions that failures trigger in debug builds.
+- (void)ignoringAssertions:(dispatch_block_t)block
+{
+  NSMutableDictionary *threadDictionary = [NSThread currentThread].threadDictionary;
+  threadDictionary[NSAssertionHandlerKey] = [[PINTestAssertionHandler alloc] init];
+  block();
+  [threadDictionary removeObjectForKey:NSAssertionHandlerKey];
+}
+
 - (void)testAnInteger {
   // Write an int
   int32_t wrote = 5;
@@ -68,6 +230,60 @@ static size_t stream_writer(cmp_ctx_t *ctx, const void *data, size_t count)
   XCTAssertEqualObjects(dict, (@{ @(key0).stringValue : @(val0), @(key1) : @(val1) }));
 }
 
+- (void)testDecodingNumbersAsStrings
+{
+  XCTAssertTrue(cmp_write_array(&writeCtx, 10));
+  XCTAssertTrue(cmp_write_s8(&writeCtx, -5));
+  XCTAssertTrue(cmp_write_u8(&writeCtx, 200));
+  XCTAssertTrue(cmp_write_s64(&writeCtx, INT64_MIN));
+  XCTAssertTrue(cmp_write_u64(&writeCtx, UINT64_MAX));
+  XCTAssertTrue(cmp_write_double(&writeCtx, 0.1));
+  XCTAssertTrue(cmp_write_double(&writeCtx, 2));
+  XCTAssertTrue(cmp_write_double(&writeCtx, 1.0 / 3));
+  XCTAssertTrue(cmp_write_double(&writeCtx, 1.5e-7));
+  XCTAssertTrue(cmp_write_double(&writeCtx, 1e21));
+  XCTAssertTrue(cmp_write_float(&writeCtx, 0.1f));
+
+  NSArray<NSString *> *strings = [u decodeArrayOfClass:[NSString class]];
+  XCTAssertNil(u.error);
+  // Doubles come out as the shortest decimal that reads back the same.
+  XCTAssertEqualObjects(strings, (@[ @"-5", @"200", @"-9223372036854775808", @"18446744073709551615",
+                                     @"0.1", @"2", @"0.3333333333333333", @"1.5e-7", @"1e+21", @"0.1" ]));
+}
+
+- (void)testDecodedDoubleStringsRoundTrip
+{
+  const double values[] = { 3.141592653589793, 5e-324, DBL_MAX, -0.0, 123456.789, 9007199254740993.0 };
+  const NSUInteger count = sizeof(values) / sizeof(values[0]);
+  XCTAssertTrue(cmp_write_array(&writeCtx, (uint32_t)count));
+  for (NSUInteger i = 0; i < count; i++) {
+    XCTAssertTrue(cmp_write_double(&writeCtx, values[i]));
+  }
+
+  NSArray<NSString *> *strings = [u decodeArrayOfClass:[NSString class]];
+  XCTAssertNil(u.error);
+  for (NSUInteger i = 0; i < count; i++) {
+    const double parsed = strtod(strings[i].UTF8String, NULL);
+    XCTAssertEqual(memcmp(&parsed, &values[i], sizeof(double)), 0, @"%@", strings[i]);
+  }
+}
+
+- (void)testInterningMapKeys {
+  char key[] = "a_key_too_long_to_be_tagged";
+  XCTAssertTrue(cmp_write_array(&writeCtx, 2));
+  for (int i = 0; i < 2; i++) {
+    XCTAssertTrue(cmp_write_map(&writeCtx, 1));
+    XCTAssertTrue(cmp_write_str(&writeCtx, key, (uint32_t)strlen(key)));
+    XCTAssertTrue(cmp_write_s32(&writeCtx, i));
+  }
+  
+  u.internsMapKeys = YES;
+  NSArray<NSDictionary *> *arr = [u decodeArrayOfClass:[NSDictionary class]];
+  XCTAssertNil(u.error);
+  XCTAssertEqualObjects(arr, (@[ @{ @(key) : @0 }, @{ @(key) : @1 } ]));
+  XCTAssertEqual(arr[0].allKeys.firstObject, arr[1].allKeys.firstObject);
+}
+
 - (void)testATaggedString {
   char wrote[] = "012345678";
   XCTAssertTrue(cmp_write_str(&writeCtx, wrote, 9));
@@ -153,6 +369,687 @@ static size_t stream_writer(cmp_ctx_t *ctx, const void *data, size_t count)
   XCTAssertEqualObjects(dict, (@{ @(key0) : @(val0), @(key1) : @(val1) }));
 }
 
+- (void)testSkippingAcrossChunks
+{
+  PINBuffer *buf = [[PINBuffer alloc] init];
+  Byte d0[3] = {0x01, 0x02, 0x03};
+  [buf writeData:[NSData dataWithBytes:d0 length:sizeof(d0)]];
+  Byte d1[3] = {0x04, 0x05, 0x06};
+  [buf writeData:[NSData dataWithBytes:d1 length:sizeof(d1)]];
+  [buf closeCompleted:YES];
+  
+  XCTAssertTrue([buf skip:4]);
+  Byte b;
+  XCTAssertTrue([buf read:&b length:1]);
+  XCTAssertEqual(b, 0x05);
+  XCTAssertFalse([buf skip:2]);
+}
+
+- (void)testPeekingContiguousBytes
+{
+  PINBuffer *buf = [[PINBuffer alloc] init];
+  Byte d0[3] = {0x01, 0x02, 0x03};
+  [buf writeData:[NSData dataWithBytes:d0 length:sizeof(d0)]];
+  Byte d1[3] = {0x04, 0x05, 0x06};
+  [buf writeData:[NSData dataWithBytes:d1 length:sizeof(d1)]];
+  [buf closeCompleted:YES];
+  
+  const Byte *bytes = [buf peekContiguousBytes:2];
+  XCTAssertTrue(bytes != NULL);
+  XCTAssertEqual(bytes[1], 0x02);
+  [buf consume:2];
+  
+  // Straddles the two chunks, so it must be read instead.
+  XCTAssertTrue([buf peekContiguousBytes:2] == NULL);
+  Byte pair[2];
+  XCTAssertTrue([buf read:pair length:2]);
+  XCTAssertEqual(pair[1], 0x04);
+  
+  bytes = [buf peekContiguousBytes:2];
+  XCTAssertTrue(bytes != NULL);
+  XCTAssertEqual(bytes[0], 0x05);
+  [buf consume:2];
+  XCTAssertTrue([buf peekContiguousBytes:1] == NULL);
+}
+
+- (void)testDecodingPayloadsInPlaceAndAcrossChunks
+{
+  // One chunk holding a whole string and bin, then a string split in two.
+  const char packed[] = "\xa5" "hello" "\xc4\x03" "abc" "\xa6" "wor";
+  [writeBuffer writeData:[NSData dataWithBytes:packed length:sizeof(packed) - 1]];
+  [writeBuffer writeData:[NSData dataWithBytes:"ld!" length:3]];
+  [writeBuffer closeCompleted:YES];
+  
+  XCTAssertEqualObjects([u decodeObjectOfClass:[NSString class]], @"hello");
+  XCTAssertEqualObjects([u decodeObjectOfClass:[NSData class]], [NSData dataWithBytes:"abc" length:3]);
+  XCTAssertEqualObjects([u decodeObjectOfClass:[NSString class]], @"world!");
+  XCTAssertNil(u.error);
+}
+
+- (void)testDecodingBinaryDataWithoutCopying
+{
+  NSMutableData *blob = [NSMutableData dataWithLength:1000];
+  memset(blob.mutableBytes, 0xab, blob.length);
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:blob];
+  NSData *packed = [NSData dataWithData:[packer encodedData]];
+  
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:packed];
+  unpacker.decodesBinaryDataWithoutCopying = YES;
+  NSData *result = [unpacker decodeObjectOfClass:[NSData class]];
+  XCTAssertEqualObjects(result, blob);
+  
+  // It points into the input.
+  const Byte *start = packed.bytes;
+  XCTAssertTrue(result.bytes > (const void *)start && result.bytes < (const void *)(start + packed.length));
+}
+
+- (void)testDecodingBinaryDataWithoutCopyingAcrossChunks
+{
+  u.decodesBinaryDataWithoutCopying = YES;
+  const char packed[] = "\xc4\x06" "ab";
+  [writeBuffer writeData:[NSData dataWithBytes:packed length:sizeof(packed) - 1]];
+  [writeBuffer writeData:[NSData dataWithBytes:"cd" length:2]];
+  [writeBuffer writeData:[NSData dataWithBytes:"ef" length:2]];
+  [writeBuffer closeCompleted:YES];
+  
+  XCTAssertEqualObjects([u decodeObjectOfClass:[NSData class]], [NSData dataWithBytes:"abcdef" length:6]);
+  XCTAssertNil(u.error);
+}
+
+- (void)testDecodingLazily
+{
+  NSDictionary *object = @{ @"items": @[ @1, @"two", @{ @"three": @3 } ], @"name": @"lazy" };
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:object];
+  
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+  unpacker.decodesLazily = YES;
+  NSDictionary *result = [unpacker decodeObjectOfClass:Nil];
+  XCTAssertNil(unpacker.error);
+  XCTAssertEqual(result.count, 2);
+  XCTAssertEqualObjects(result[@"name"], @"lazy");
+  NSArray *items = result[@"items"];
+  XCTAssertEqual(items.count, 3);
+  XCTAssertEqualObjects(items[2], @{ @"three": @3 });
+  XCTAssertEqualObjects(result, object);
+}
+
+- (void)testDecodingLazilySharesInternedStrings
+{
+  NSString *value = @"repeated value";
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:@[ @[ value ], @[ value ], value ]];
+
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+  unpacker.decodesLazily = YES;
+  unpacker.maximumInternedValueLength = 32;
+  NSArray *result = [unpacker decodeObjectOfClass:Nil];
+  XCTAssertNil(unpacker.error);
+  // Elements of nested collections are decoded by the same unpacker.
+  XCTAssertEqualObjects(result[0][0], value);
+  XCTAssertEqual(result[0][0], result[1][0]);
+  XCTAssertEqual(result[0][0], result[2]);
+}
+
+- (void)testDecodingLazilyReadsInvalidValuesAsNull
+{
+  NSData *data = [self messagePackDataWithBlock:^(cmp_ctx_t *ctx) {
+    cmp_write_array(ctx, 2);
+    cmp_write_u8(ctx, 1);
+    // No handler is registered for this type.
+    cmp_write_ext(ctx, 42, 2, "ab");
+  }];
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:data];
+  unpacker.decodesLazily = YES;
+  NSArray *result = [unpacker decodeObjectOfClass:Nil];
+  XCTAssertNil(unpacker.error);
+  XCTAssertEqualObjects(result[0], @1);
+  // Not an assertion, in debug or release.
+  XCTAssertEqualObjects(result[1], [NSNull null]);
+}
+
+- (void)testDecodingLazilyFromACompletedBuffer
+{
+  XCTAssertTrue(cmp_write_array(&writeCtx, 2));
+  XCTAssertTrue(cmp_write_str(&writeCtx, "a", 1));
+  XCTAssertTrue(cmp_write_s32(&writeCtx, 70000));
+  [writeBuffer closeCompleted:YES];
+  
+  u.decodesLazily = YES;
+  NSArray *result = [u decodeObjectOfClass:Nil];
+  XCTAssertNil(u.error);
+  XCTAssertEqualObjects(result, (@[ @"a", @70000 ]));
+}
+
+- (void)testProjectingKeyPaths
+{
+  NSDictionary *object = @{
+    @"data": @{
+      @"items": @[ @{ @"id": @1, @"title": @"one" }, @{ @"id": @2, @"title": @"two" }, @3 ],
+      @"bookmark": @"abc",
+      @"blob": [NSMutableData dataWithLength:10000]
+    },
+    @"status": @"ok"
+  };
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:object];
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+  
+  NSDictionary *result = [unpacker decodeObjectOfClass:[NSDictionary class] projectingKeyPaths:@[ @"data.items[*].id", @"data.bookmark", @"missing" ]];
+  XCTAssertNil(unpacker.error);
+  NSDictionary *expected = @{
+    @"data": @{
+      @"items": @[ @{ @"id": @1 }, @{ @"id": @2 }, [NSNull null] ],
+      @"bookmark": @"abc"
+    }
+  };
+  XCTAssertEqualObjects(result, expected);
+}
+
+- (void)testProjectingKeyPathsFromABuffer
+{
+  XCTAssertTrue(cmp_write_array(&writeCtx, 2));
+  for (int i = 0; i < 2; i++) {
+    XCTAssertTrue(cmp_write_map(&writeCtx, 2));
+    XCTAssertTrue(cmp_write_str(&writeCtx, "skipped", 7));
+    XCTAssertTrue(cmp_write_array(&writeCtx, 1));
+    XCTAssertTrue(cmp_write_str(&writeCtx, "x", 1));
+    XCTAssertTrue(cmp_write_str(&writeCtx, "id", 2));
+    XCTAssertTrue(cmp_write_s32(&writeCtx, i));
+  }
+  // Make sure we stop where the value ends.
+  XCTAssertTrue(cmp_write_s32(&writeCtx, 42));
+  [writeBuffer closeCompleted:YES];
+  
+  NSArray *result = [u decodeObjectOfClass:Nil projectingKeyPaths:@[ @"[*].id" ]];
+  XCTAssertEqualObjects(result, (@[ @{ @"id": @0 }, @{ @"id": @1 } ]));
+  XCTAssertEqual([u decodeInteger], 42);
+  XCTAssertNil(u.error);
+}
+
+- (void)testEnumeratingMessagesAsTheyArrive
+{
+  // Write one message at a time from another thread, waiting for each to be read.
+  dispatch_semaphore_t received = dispatch_semaphore_create(0);
+  PINBuffer *buffer = writeBuffer;
+  dispatch_async(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+    for (NSInteger i = 0; i < 3; i++) {
+      PINMessagePacker *packer = [[PINMessagePacker alloc] initWithBuffer:buffer];
+      [packer encodeObject:@{ @"event": @(i) }];
+      [packer flush];
+      dispatch_semaphore_wait(received, DISPATCH_TIME_FOREVER);
+    }
+    [buffer closeCompleted:YES];
+  });
+  
+  NSMutableArray *messages = [NSMutableArray array];
+  [u enumerateMessagesOfClass:[NSDictionary class] usingBlock:^(id message, BOOL *stop) {
+    [messages addObject:message];
+    dispatch_semaphore_signal(received);
+  }];
+  XCTAssertNil(u.error);
+  XCTAssertEqualObjects(messages, (@[ @{ @"event": @0 }, @{ @"event": @1 }, @{ @"event": @2 } ]));
+}
+
+- (void)testEnumeratingMessagesFromData
+{
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:@"first"];
+  [packer encodeNil];
+  [packer encodeObject:@"last"];
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+  
+  NSMutableArray *messages = [NSMutableArray array];
+  [unpacker enumerateMessagesOfClass:Nil usingBlock:^(id message, BOOL *stop) {
+    [messages addObject:message ?: [NSNull null]];
+  }];
+  XCTAssertNil(unpacker.error);
+  XCTAssertEqualObjects(messages, (@[ @"first", [NSNull null], @"last" ]));
+}
+
+- (void)testPushingMessagesOneByteAtATime
+{
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:@{ @"name": @"Garrett", @"scores": @[ @1, @2.5, @-300000 ] }];
+  [packer encodeNil];
+  [packer encodeObject:[NSMutableData dataWithLength:300]];
+  NSData *data = [packer encodedData];
+
+  NSMutableArray *messages = [NSMutableArray array];
+  PINMessagePushUnpacker *unpacker = [[PINMessagePushUnpacker alloc] initWithClass:Nil messageHandler:^(id message) {
+    [messages addObject:message ?: [NSNull null]];
+  }];
+  for (NSUInteger i = 0; i < data.length; i++) {
+    NSUInteger count = messages.count;
+    XCTAssertTrue([unpacker consumeData:[data subdataWithRange:NSMakeRange(i, 1)]]);
+    // We're at a boundary exactly when a byte completes a message.
+    XCTAssertEqual(unpacker.atMessageBoundary, messages.count > count);
+  }
+  XCTAssertNil(unpacker.error);
+  XCTAssertTrue(unpacker.atMessageBoundary);
+  XCTAssertEqualObjects(messages, (@[ @{ @"name": @"Garrett", @"scores": @[ @1, @2.5, @-300000 ] }, [NSNull null], [NSMutableData dataWithLength:300] ]));
+}
+
+- (void)testPushingMessagesInChunks
+{
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  for (NSInteger i = 0; i < 100; i++) {
+    [packer encodeObject:@[ @(i), [NSString stringWithFormat:@"message %ld", (long)i] ]];
+  }
+  NSData *data = [packer encodedData];
+
+  NSMutableArray *messages = [NSMutableArray array];
+  PINMessagePushUnpacker *unpacker = [[PINMessagePushUnpacker alloc] initWithClass:[NSArray class] messageHandler:^(id message) {
+    [messages addObject:message];
+  }];
+  for (NSUInteger i = 0; i < data.length; i += 7) {
+    XCTAssertTrue([unpacker consumeData:[data subdataWithRange:NSMakeRange(i, MIN(7, data.length - i))]]);
+  }
+  XCTAssertTrue(unpacker.atMessageBoundary);
+  XCTAssertEqual(messages.count, 100);
+  XCTAssertEqualObjects(messages.lastObject, (@[ @99, @"message 99" ]));
+
+  // A truncated message is held back until the rest arrives.
+  XCTAssertTrue([unpacker consumeData:[data subdataWithRange:NSMakeRange(0, 3)]]);
+  XCTAssertFalse(unpacker.atMessageBoundary);
+  XCTAssertEqual(messages.count, 100);
+}
+
+- (void)testPushingAnInvalidMarker
+{
+  __block NSUInteger messageCount = 0;
+  PINMessagePushUnpacker *unpacker = [[PINMessagePushUnpacker alloc] initWithClass:Nil messageHandler:^(id message) {
+    messageCount++;
+  }];
+  // 0xc1 is never used.
+  [self ignoringAssertions:^{
+    XCTAssertFalse([unpacker consumeData:[NSData dataWithBytes:"\x01\xc1\x02" length:3]]);
+  }];
+  XCTAssertEqual(unpacker.error.code, PINMessagePackErrorInvalidType);
+  XCTAssertEqual(messageCount, 1);
+  XCTAssertFalse([unpacker consumeData:[NSData dataWithBytes:"\x03" length:1]]);
+  XCTAssertEqual(messageCount, 1);
+}
+
+- (void)testPushingAnInvalidMessageSplitAcrossChunks
+{
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:@[ @1, @2 ]];
+  [packer encodeObject:@{ @"not": @"an array" }];
+  [packer encodeObject:@[ @3 ]];
+  NSData *data = [packer encodedData];
+
+  NSMutableArray *messages = [NSMutableArray array];
+  PINMessagePushUnpacker *unpacker = [[PINMessagePushUnpacker alloc] initWithClass:[NSArray class] messageHandler:^(id message) {
+    [messages addObject:message];
+  }];
+  // The first chunk ends inside the map.
+  XCTAssertTrue([unpacker consumeData:[data subdataWithRange:NSMakeRange(0, 6)]]);
+  [self ignoringAssertions:^{
+    XCTAssertFalse([unpacker consumeData:[data subdataWithRange:NSMakeRange(6, data.length - 6)]]);
+  }];
+  XCTAssertEqual(unpacker.error.code, PINMessagePackErrorInvalidType);
+  XCTAssertEqualObjects(messages, (@[ @[ @1, @2 ] ]));
+}
+
+- (void)testPushingAMessageOverTheMaximumLength
+{
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:@"short"];
+  [packer encodeObject:[NSMutableData dataWithLength:1000]];
+  NSData *data = [packer encodedData];
+
+  NSMutableArray *messages = [NSMutableArray array];
+  PINMessagePushUnpacker *unpacker = [[PINMessagePushUnpacker alloc] initWithClass:Nil messageHandler:^(id message) {
+    [messages addObject:message];
+  }];
+  unpacker.maximumMessageLength = 100;
+  XCTAssertTrue([unpacker consumeData:[data subdataWithRange:NSMakeRange(0, 60)]]);
+  XCTAssertFalse([unpacker consumeData:[data subdataWithRange:NSMakeRange(60, 60)]]);
+  XCTAssertEqual(unpacker.error.code, PINMessagePackErrorInputTooLarge);
+  XCTAssertEqualObjects(messages, @[ @"short" ]);
+}
+
+- (void)testDecodingTimestamps
+{
+  // Timestamp 32: 2023-11-14T22:13:20Z.
+  const uint8_t ts32[] = { 0x65, 0x53, 0xf1, 0x00 };
+  // Timestamp 64: one second and a half after the epoch.
+  const uint8_t ts64[] = { 0x77, 0x35, 0x94, 0x00, 0x00, 0x00, 0x00, 0x01 };
+  // Timestamp 96: one second before the epoch, which needs a signed value.
+  const uint8_t ts96[] = { 0, 0, 0, 0, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+  XCTAssertTrue(cmp_write_array(&writeCtx, 3));
+  XCTAssertTrue(cmp_write_ext(&writeCtx, -1, sizeof(ts32), ts32));
+  XCTAssertTrue(cmp_write_ext(&writeCtx, -1, sizeof(ts64), ts64));
+  XCTAssertTrue(cmp_write_ext(&writeCtx, -1, sizeof(ts96), ts96));
+
+  NSArray<NSDate *> *dates = [u decodeArrayOfClass:[NSDate class]];
+  XCTAssertNil(u.error);
+  XCTAssertEqualObjects(dates, (@[ [NSDate dateWithTimeIntervalSince1970:1700000000],
+                                   [NSDate dateWithTimeIntervalSince1970:1.5],
+                                   [NSDate dateWithTimeIntervalSince1970:-1] ]));
+}
+
+- (void)testRoundTrippingDates
+{
+  NSArray<NSDate *> *dates = @[ [NSDate dateWithTimeIntervalSince1970:0],
+                                [NSDate dateWithTimeIntervalSince1970:1700000000.25],
+                                [NSDate dateWithTimeIntervalSince1970:-86400.5],
+                                [NSDate distantFuture] ];
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:dates];
+  XCTAssertNil(packer.error);
+
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+  NSArray<NSDate *> *decoded = [unpacker decodeArrayOfClass:[NSDate class]];
+  XCTAssertNil(unpacker.error);
+  XCTAssertEqual(decoded.count, dates.count);
+  for (NSUInteger i = 0; i < dates.count; i++) {
+    XCTAssertEqualWithAccuracy(decoded[i].timeIntervalSinceReferenceDate, dates[i].timeIntervalSinceReferenceDate, 1e-6);
+  }
+}
+
+- (void)testRegisteringExtensionTypes
+{
+  NSUUID *uuid = [NSUUID UUID];
+  uuid_t uuidBytes;
+  [uuid getUUIDBytes:uuidBytes];
+  const int32_t cents = 12345;
+  XCTAssertTrue(cmp_write_map(&writeCtx, 2));
+  XCTAssertTrue(cmp_write_str(&writeCtx, "id", 2));
+  XCTAssertTrue(cmp_write_ext(&writeCtx, 1, sizeof(uuidBytes), uuidBytes));
+  XCTAssertTrue(cmp_write_str(&writeCtx, "price", 5));
+  XCTAssertTrue(cmp_write_ext(&writeCtx, 2, sizeof(cents), &cents));
+
+  [u registerExtensionType:1 class:[PINTestIdentifier class]];
+  [u registerExtensionType:2 handler:^id(int8_t type, const void *bytes, NSUInteger length) {
+    int32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return [NSDecimalNumber decimalNumberWithMantissa:value exponent:-2 isNegative:NO];
+  }];
+  NSDictionary *dict = [u decodeDictionaryWithKeyClass:[NSString class] objectClass:Nil];
+  XCTAssertNil(u.error);
+  XCTAssertEqualObjects([dict[@"id"] UUID], uuid);
+  XCTAssertEqualObjects(dict[@"price"], [NSDecimalNumber decimalNumberWithString:@"123.45"]);
+}
+
+- (void)testDecodingPrimitivesOfEveryWidth
+{
+  XCTAssertTrue(cmp_write_s32(&writeCtx, INT32_MIN));
+  XCTAssertTrue(cmp_write_u32(&writeCtx, UINT32_MAX));
+  XCTAssertTrue(cmp_write_s64(&writeCtx, INT64_MIN));
+  XCTAssertTrue(cmp_write_u64(&writeCtx, UINT64_MAX));
+  XCTAssertTrue(cmp_write_s8(&writeCtx, 7));
+  XCTAssertTrue(cmp_write_float(&writeCtx, 1.5f));
+  XCTAssertTrue(cmp_write_double(&writeCtx, 2.25));
+
+  XCTAssertEqual([u decodeInt32], INT32_MIN);
+  XCTAssertEqual([u decodeUInt32], UINT32_MAX);
+  XCTAssertEqual([u decodeInt64], INT64_MIN);
+  XCTAssertEqual([u decodeUInt64], UINT64_MAX);
+  // Signed encodings of non-negative values are fine for unsigned decoders.
+  XCTAssertEqual([u decodeUInt64], 7);
+  XCTAssertEqual([u decodeFloat], 1.5f);
+  XCTAssertEqual([u decodeFloat], 2.25f);
+  XCTAssertNil(u.error);
+}
+
+- (void)testDecodingOptionalPrimitives
+{
+  XCTAssertTrue(cmp_write_nil(&writeCtx));
+  XCTAssertTrue(cmp_write_s16(&writeCtx, -300));
+  XCTAssertTrue(cmp_write_nil(&writeCtx));
+  XCTAssertTrue(cmp_write_double(&writeCtx, 0.5));
+  XCTAssertTrue(cmp_write_nil(&writeCtx));
+  XCTAssertTrue(cmp_write_false(&writeCtx));
+
+  BOOL present = YES;
+  XCTAssertEqual([u decodeOptionalInt64:&present], 0);
+  XCTAssertFalse(present);
+  XCTAssertEqual([u decodeOptionalInt64:&present], -300);
+  XCTAssertTrue(present);
+  XCTAssertEqual([u decodeOptionalDouble:&present], 0);
+  XCTAssertFalse(present);
+  XCTAssertEqual([u decodeOptionalDouble:&present], 0.5);
+  XCTAssertTrue(present);
+  XCTAssertEqual([u decodeOptionalBOOL:&present], NO);
+  XCTAssertFalse(present);
+  XCTAssertEqual([u decodeOptionalBOOL:&present], NO);
+  XCTAssertTrue(present);
+  XCTAssertNil(u.error);
+}
+
+- (void)testSharingSmallNumbers
+{
+  XCTAssertTrue(cmp_write_array(&writeCtx, 4));
+  XCTAssertTrue(cmp_write_s8(&writeCtx, -32));
+  XCTAssertTrue(cmp_write_s32(&writeCtx, -32));
+  XCTAssertTrue(cmp_write_u8(&writeCtx, 255));
+  XCTAssertTrue(cmp_write_u16(&writeCtx, 255));
+
+  NSArray<NSNumber *> *numbers = [u decodeArrayOfClass:[NSNumber class]];
+  XCTAssertNil(u.error);
+  XCTAssertEqualObjects(numbers, (@[ @-32, @-32, @255, @255 ]));
+  // However they're encoded, small values decode to the same instance.
+  XCTAssertEqual(numbers[0], numbers[1]);
+  XCTAssertEqual(numbers[2], numbers[3]);
+}
+
+- (void)testCollectingDecodingStatistics
+{
+  u.collectsStatistics = YES;
+  NSData *data = [self messagePackDataWithBlock:^(cmp_ctx_t *ctx) {
+    cmp_write_map(ctx, 2);
+    cmp_write_str(ctx, "a", 1);
+    cmp_write_array(ctx, 3);
+    cmp_write_u8(ctx, 1);
+    cmp_write_double(ctx, 0.5);
+    cmp_write_nil(ctx);
+    cmp_write_str(ctx, "b", 1);
+    cmp_write_true(ctx);
+    cmp_write_s16(ctx, -300);
+  }];
+  [writeBuffer writeData:[data subdataWithRange:NSMakeRange(0, 5)]];
+  [writeBuffer writeData:[data subdataWithRange:NSMakeRange(5, data.length - 5)]];
+  [writeBuffer closeCompleted:YES];
+
+  XCTAssertNotNil([u decodeObjectOfClass:[NSDictionary class]]);
+  XCTAssertNotNil([u decodeObjectOfClass:[NSNumber class]]);
+  XCTAssertNil(u.error);
+  PINDecodingStatistics stats = u.statistics;
+  XCTAssertEqual(stats.messageCount, 2);
+  XCTAssertEqual(stats.objectCounts[PINMessagePackTypeMap], 1);
+  XCTAssertEqual(stats.objectCounts[PINMessagePackTypeArray], 1);
+  XCTAssertEqual(stats.objectCounts[PINMessagePackTypeString], 2);
+  XCTAssertEqual(stats.objectCounts[PINMessagePackTypeInteger], 2);
+  XCTAssertEqual(stats.objectCounts[PINMessagePackTypeFloat], 1);
+  XCTAssertEqual(stats.objectCounts[PINMessagePackTypeNil], 1);
+  XCTAssertEqual(stats.objectCounts[PINMessagePackTypeBoolean], 1);
+  XCTAssertEqual(stats.maximumDepth, 2);
+  XCTAssertEqual(stats.largestContainerCount, 3);
+
+  PINBufferStatistics bufferStats = writeBuffer.statistics;
+  XCTAssertEqual(bufferStats.bytesConsumed, data.length);
+  XCTAssertEqual(bufferStats.chunksProcessed, 2);
+}
+
+- (void)testStatisticsAreOffByDefault
+{
+  XCTAssertTrue(cmp_write_array(&writeCtx, 1));
+  XCTAssertTrue(cmp_write_u8(&writeCtx, 1));
+  [writeBuffer closeCompleted:YES];
+
+  XCTAssertNotNil([u decodeArrayOfClass:[NSNumber class]]);
+  XCTAssertEqual(u.statistics.messageCount, 0);
+  XCTAssertEqual(u.statistics.objectCounts[PINMessagePackTypeInteger], 0);
+  XCTAssertEqual(writeBuffer.statistics.bytesConsumed, 0);
+}
+
+- (void)testTracingMessages
+{
+  NSUInteger counts[2] = { 0, 0 };
+  PINMessageUnpackerSetTraceFunction(PINTestCountTraceEvents, counts);
+  for (NSInteger i = 0; i < 3; i++) {
+    XCTAssertTrue(cmp_write_array(&writeCtx, 2));
+    XCTAssertTrue(cmp_write_s64(&writeCtx, i));
+    XCTAssertTrue(cmp_write_array(&writeCtx, 0));
+  }
+  [writeBuffer closeCompleted:YES];
+
+  [u enumerateMessagesOfClass:Nil usingBlock:^(id message, BOOL *stop) {}];
+  PINMessageUnpackerSetTraceFunction(NULL, NULL);
+  XCTAssertNil(u.error);
+  // Nested values aren't messages.
+  XCTAssertEqual(counts[PINMessageTraceEventBegin], 3);
+  XCTAssertEqual(counts[PINMessageTraceEventEnd], 3);
+}
+
+- (void)testDecodingIntoMutableContainers
+{
+  NSMutableArray *array = [NSMutableArray arrayWithObjects:@"stale", @"stale", @"stale", nil];
+  NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithObjectsAndKeys:@1, @"kept", @2, @"stale", nil];
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:@[ @"a", @"b" ]];
+  [packer encodeObject:@{ @"kept": @3, @"new": @4 }];
+  [packer encodeObject:@{ @"kept": @5, @"new": @6 }];
+  [packer encodeObject:@"not an array"];
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+
+  XCTAssertTrue([unpacker decodeArrayOfClass:[NSString class] intoArray:array]);
+  XCTAssertEqualObjects(array, (@[ @"a", @"b" ]));
+  XCTAssertTrue([unpacker decodeDictionaryWithKeyClass:[NSString class] objectClass:[NSNumber class] intoDictionary:dictionary]);
+  XCTAssertEqualObjects(dictionary, (@{ @"kept": @3, @"new": @4 }));
+  // Same keys, so nothing to remove.
+  XCTAssertTrue([unpacker decodeDictionaryWithKeyClass:Nil objectClass:Nil intoDictionary:dictionary]);
+  XCTAssertEqualObjects(dictionary, (@{ @"kept": @5, @"new": @6 }));
+  XCTAssertNil(unpacker.error);
+  [self ignoringAssertions:^{
+    XCTAssertFalse([unpacker decodeArrayOfClass:Nil intoArray:array]);
+  }];
+  XCTAssertNotNil(unpacker.error);
+}
+
+- (void)testMergingIntoAnObjectGraph
+{
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:@{ @"items": @[ @{ @"id": @1 }, @{ @"id": @2 } ], @"cursor": @"a" }];
+  [packer encodeObject:@{ @"items": @[ @{ @"id": @3, @"seen": @YES } ], @"total": @10 }];
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+
+  NSMutableDictionary *page = [unpacker decodeObjectMergingIntoObject:nil];
+  XCTAssertTrue([page isKindOfClass:[NSMutableDictionary class]]);
+  NSMutableArray *items = page[@"items"];
+  NSMutableDictionary *firstItem = items[0];
+  XCTAssertEqualObjects(page, (@{ @"items": @[ @{ @"id": @1 }, @{ @"id": @2 } ], @"cursor": @"a" }));
+
+  // Containers are updated in place, and keys that aren't sent again are kept.
+  XCTAssertEqual([unpacker decodeObjectMergingIntoObject:page], page);
+  XCTAssertNil(unpacker.error);
+  XCTAssertEqual(page[@"items"], items);
+  XCTAssertEqual(items[0], firstItem);
+  XCTAssertEqualObjects(page, (@{ @"items": @[ @{ @"id": @3, @"seen": @YES } ], @"cursor": @"a", @"total": @10 }));
+}
+
+- (void)testMergingIntoADecodedGraph
+{
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:@{ @"items": @[ @{ @"id": @1, @"title": @"one" }, @{ @"id": @2, @"title": @"two" } ], @"cursor": @"a" }];
+  [packer encodeObject:@{ @"items": @[ @{ @"id": @3 } ], @"total": @10 }];
+  [packer encodeObject:@{ @"cursor": @"b" }];
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+
+  // Decoded without merging, so every container is immutable.
+  NSDictionary *page = [unpacker decodeObjectOfClass:Nil];
+  XCTAssertNil(unpacker.error);
+
+  NSMutableDictionary *merged = [unpacker decodeObjectMergingIntoObject:page];
+  XCTAssertNil(unpacker.error);
+  XCTAssertEqualObjects(merged, (@{ @"items": @[ @{ @"id": @3, @"title": @"one" } ], @"cursor": @"a", @"total": @10 }));
+  // The original is untouched.
+  XCTAssertEqualObjects(page[@"items"][0][@"id"], @1);
+
+  // The copies are mutable, so the next merge updates them in place.
+  NSMutableArray *items = merged[@"items"];
+  XCTAssertEqual([unpacker decodeObjectMergingIntoObject:merged], merged);
+  XCTAssertNil(unpacker.error);
+  XCTAssertEqual(merged[@"items"], items);
+  XCTAssertEqualObjects(merged[@"cursor"], @"b");
+}
+
+- (void)testMergingIntoCustomObjects
+{
+  PINTestMergeablePoint *point = [[PINTestMergeablePoint alloc] init];
+  point.x = 1;
+  point.y = 2;
+  point.name = @"origin";
+  NSMutableDictionary *graph = [NSMutableDictionary dictionaryWithObject:point forKey:@"point"];
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:@{ @"point": @{ @"x": @5 } }];
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+
+  XCTAssertEqual([unpacker decodeObjectMergingIntoObject:graph], graph);
+  XCTAssertNil(unpacker.error);
+  XCTAssertEqual(graph[@"point"], point);
+  XCTAssertEqual(point.x, 5);
+  XCTAssertEqual(point.y, 2);
+  XCTAssertEqualObjects(point.name, @"origin");
+}
+
+- (void)testSkippingValuesInAMap
+{
+  NSMutableData *blob = [NSMutableData dataWithLength:100000];
+  XCTAssertTrue(cmp_write_map(&writeCtx, 3));
+  XCTAssertTrue(cmp_write_str(&writeCtx, "nested", 6));
+  XCTAssertTrue(cmp_write_array(&writeCtx, 2));
+  XCTAssertTrue(cmp_write_s32(&writeCtx, 1));
+  XCTAssertTrue(cmp_write_map(&writeCtx, 1));
+  XCTAssertTrue(cmp_write_str(&writeCtx, "x", 1));
+  XCTAssertTrue(cmp_write_str(&writeCtx, "y", 1));
+  XCTAssertTrue(cmp_write_str(&writeCtx, "blob", 4));
+  XCTAssertTrue(cmp_write_bin(&writeCtx, blob.bytes, (uint32_t)blob.length));
+  XCTAssertTrue(cmp_write_str(&writeCtx, "keep", 4));
+  XCTAssertTrue(cmp_write_s32(&writeCtx, 5));
+  
+  __block NSInteger kept = 0;
+  [u enumerateKeysInMapWithBlock:^(const char *key, NSUInteger keyLen) {
+    if (strncmp(key, "keep", keyLen) == 0) {
+      kept = [u decodeInteger];
+    } else {
+      [u skipValue];
+    }
+  }];
+  XCTAssertNil(u.error);
+  XCTAssertEqual(kept, 5);
+}
+
+- (void)testLargeCollectionsAndStrings
+{
+  // Big enough to overflow a 512KB background thread stack if decoded onto the stack.
+  const uint32_t count = 200000;
+  NSMutableData *longString = [NSMutableData dataWithLength:1024 * 1024];
+  memset(longString.mutableBytes, 'a', longString.length);
+  XCTAssertTrue(cmp_write_map(&writeCtx, 2));
+  XCTAssertTrue(cmp_write_str(&writeCtx, "array", 5));
+  XCTAssertTrue(cmp_write_array(&writeCtx, count));
+  for (uint32_t i = 0; i < count; i++) {
+    XCTAssertTrue(cmp_write_u32(&writeCtx, i));
+  }
+  XCTAssertTrue(cmp_write_str(&writeCtx, "string", 6));
+  XCTAssertTrue(cmp_write_str(&writeCtx, longString.bytes, (uint32_t)longString.length));
+  [writeBuffer closeCompleted:YES];
+  
+  __block NSDictionary *dict;
+  dispatch_sync(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+    dict = [u decodeDictionaryWithKeyClass:[NSString class] objectClass:Nil];
+  });
+  XCTAssertNil(u.error);
+  NSArray *array = dict[@"array"];
+  XCTAssertEqual(array.count, count);
+  XCTAssertEqualObjects(array.lastObject, @(count - 1));
+  XCTAssertEqual([dict[@"string"] length], longString.length);
+}
+
 - (void)testReadingAllData
 {
   PINBuffer *buf = [[PINBuffer alloc] init];
@@ -188,6 +1085,210 @@ static size_t stream_writer(cmp_ctx_t *ctx, const void *data, size_t count)
   XCTAssertEqualObjects([buf readAllData], expected);
 }
 
+- (void)testReadingAllChunksWithoutCopying
+{
+  PINBuffer *buf = [[PINBuffer alloc] init];
+  buf.preserveData = YES;
+  NSMutableData *d0 = [NSMutableData dataWithBytes:"\x01\x02" length:2];
+  [buf writeDataNoCopy:d0];
+  NSData *d1 = [NSData dataWithBytes:"\x04\x05" length:2];
+  [buf writeData:d1];
+  [buf closeCompleted:YES];
+
+  NSArray<NSData *> *chunks = [buf readAllChunks];
+  XCTAssertEqual(chunks.count, 2);
+  // Ownership was transferred, so the mutable data wasn't copied.
+  XCTAssertEqual(chunks[0], d0);
+  XCTAssertEqual(chunks[1].bytes, d1.bytes);
+  XCTAssertEqualObjects([buf readAllChunks], chunks);
+}
+
+- (void)testReadingOneChunkWithoutCopying
+{
+  PINBuffer *buf = [[PINBuffer alloc] init];
+  NSData *data = [NSData dataWithBytes:"\x01\x02\x03" length:3];
+  [buf writeData:data];
+  [buf closeCompleted:YES];
+  XCTAssertEqual([buf readAllData].bytes, data.bytes);
+  XCTAssertEqualObjects([buf readAllChunks], @[]);
+}
+
+- (void)testWritingDispatchDataRegions
+{
+  writeBuffer.collectsStatistics = YES;
+  dispatch_data_t first = dispatch_data_create("\x92\xcd", 2, NULL, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+  dispatch_data_t second = dispatch_data_create("\x01\x00\x2a", 3, NULL, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+  [writeBuffer writeDispatchData:dispatch_data_create_concat(first, second)];
+  [writeBuffer closeCompleted:YES];
+
+  // The uint16 spans the two regions.
+  XCTAssertEqualObjects([u decodeArrayOfClass:[NSNumber class]], (@[ @256, @42 ]));
+  XCTAssertNil(u.error);
+  // One chunk per region, rather than one flattened chunk.
+  XCTAssertEqual(writeBuffer.statistics.chunksProcessed, 2);
+}
+
+- (void)testWritingNoncontiguousData
+{
+  writeBuffer.collectsStatistics = YES;
+  dispatch_data_t first = dispatch_data_create("\x92\xcd", 2, NULL, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+  dispatch_data_t second = dispatch_data_create("\x01\x00\x2a", 3, NULL, DISPATCH_DATA_DESTRUCTOR_DEFAULT);
+  [writeBuffer writeData:(NSData *)dispatch_data_create_concat(first, second)];
+  [writeBuffer closeCompleted:YES];
+
+  XCTAssertEqualObjects([u decodeArrayOfClass:[NSNumber class]], (@[ @256, @42 ]));
+  XCTAssertNil(u.error);
+  // Split into regions, rather than flattened when read.
+  XCTAssertEqual(writeBuffer.statistics.chunksProcessed, 2);
+}
+
+- (void)testHighAndLowWaterMarks
+{
+  PINBuffer *buf = [[PINBuffer alloc] init];
+  buf.highWaterMark = 8;
+  buf.lowWaterMark = 4;
+  __block NSUInteger handlerCount = 0;
+  buf.spaceAvailableHandler = ^{
+    handlerCount++;
+  };
+  NSData *chunk = [NSData dataWithBytes:"\x01\x02\x03\x04" length:4];
+  [buf writeData:chunk];
+  XCTAssertTrue(buf.hasSpaceAvailable);
+  [buf writeData:chunk];
+  XCTAssertEqual(buf.bufferedByteCount, 8);
+  XCTAssertFalse(buf.hasSpaceAvailable);
+  XCTAssertFalse([buf writeData:chunk timeout:0.01]);
+  XCTAssertEqual(buf.bufferedByteCount, 8);
+
+  // Chunks count until they're finished, and we resume at the low-water mark.
+  uint8_t bytes[4];
+  XCTAssertTrue([buf read:bytes length:3]);
+  XCTAssertEqual(buf.bufferedByteCount, 8);
+  XCTAssertTrue([buf read:bytes length:1]);
+  XCTAssertEqual(buf.bufferedByteCount, 4);
+  XCTAssertTrue(buf.hasSpaceAvailable);
+  XCTAssertEqual(handlerCount, 1);
+  XCTAssertTrue([buf writeData:chunk timeout:0]);
+  [buf closeCompleted:YES];
+  XCTAssertEqual([buf readRemainingData].length, 8);
+  XCTAssertEqual(buf.bufferedByteCount, 0);
+}
+
+- (void)testWritersWaitForTheReader
+{
+  PINBuffer *buf = [[PINBuffer alloc] init];
+  buf.highWaterMark = 64 * 1024;
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  for (NSInteger i = 0; i < 20000; i++) {
+    [packer encodeObject:@[ @(i), @"a string to take up some space" ]];
+  }
+  NSData *data = [packer encodedData];
+
+  __block NSUInteger maximumBufferedByteCount = 0;
+  XCTestExpectation *written = [self expectationWithDescription:@"written"];
+  dispatch_async(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+    for (NSUInteger offset = 0; offset < data.length; offset += 1024) {
+      NSData *chunk = [data subdataWithRange:NSMakeRange(offset, MIN(1024, data.length - offset))];
+      XCTAssertTrue([buf writeData:chunk timeout:10]);
+      maximumBufferedByteCount = MAX(maximumBufferedByteCount, buf.bufferedByteCount);
+    }
+    [buf closeCompleted:YES];
+    [written fulfill];
+  });
+
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithBuffer:buf];
+  __block NSInteger count = 0;
+  [unpacker enumerateMessagesOfClass:[NSArray class] usingBlock:^(id message, BOOL *stop) {
+    count++;
+  }];
+  [self waitForExpectations:@[ written ] timeout:10];
+  XCTAssertNil(unpacker.error);
+  XCTAssertEqual(count, 20000);
+  // At most one chunk over the mark.
+  XCTAssertLessThanOrEqual(maximumBufferedByteCount, 65 * 1024);
+}
+
+- (NSString *)temporaryFileWithData:(NSData *)data
+{
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+  XCTAssertTrue([data writeToFile:path atomically:NO]);
+  [self addTeardownBlock:^{
+    [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+  }];
+  return path;
+}
+
+- (void)testDecodingFromAMappedFile
+{
+  NSMutableArray *messages = [NSMutableArray array];
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  // A couple of megabytes, so there's more than one chunk.
+  for (NSInteger i = 0; i < 60000; i++) {
+    NSDictionary *message = @{ @"id": @(i), @"name": [NSString stringWithFormat:@"message number %ld", (long)i] };
+    [messages addObject:message];
+    [packer encodeObject:message];
+  }
+  NSString *path = [self temporaryFileWithData:[packer encodedData]];
+
+  NSError *error;
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithContentsOfFile:path error:&error];
+  XCTAssertNotNil(unpacker, @"%@", error);
+  NSMutableArray *decoded = [NSMutableArray array];
+  [unpacker enumerateMessagesOfClass:[NSDictionary class] usingBlock:^(id message, BOOL *stop) {
+    [decoded addObject:message];
+  }];
+  XCTAssertNil(unpacker.error);
+  XCTAssertEqualObjects(decoded, messages);
+
+  // The buffer splits the file into chunks, so some messages span them.
+  PINBuffer *buffer = [[PINBuffer alloc] initWithContentsOfFile:path error:&error];
+  XCTAssertNotNil(buffer, @"%@", error);
+  XCTAssertEqual(buffer.state, PINBufferStateCompleted);
+  unpacker = [[PINMessageUnpacker alloc] initWithBuffer:buffer];
+  [decoded removeAllObjects];
+  [unpacker enumerateMessagesOfClass:[NSDictionary class] usingBlock:^(id message, BOOL *stop) {
+    [decoded addObject:message];
+  }];
+  XCTAssertNil(unpacker.error);
+  XCTAssertEqualObjects(decoded, messages);
+}
+
+- (void)testEnumeratingMessagesWithAnEmptyLastChunk
+{
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:@1];
+  [packer encodeObject:@"two"];
+  [writeBuffer writeData:[packer encodedData]];
+  [writeBuffer writeData:[NSData data]];
+  [writeBuffer closeCompleted:YES];
+
+  NSMutableArray *decoded = [NSMutableArray array];
+  [u enumerateMessagesOfClass:Nil usingBlock:^(id message, BOOL *stop) {
+    [decoded addObject:message];
+  }];
+  XCTAssertNil(u.error);
+  XCTAssertEqualObjects(decoded, (@[ @1, @"two" ]));
+  XCTAssertTrue([writeBuffer isAtEnd]);
+}
+
+- (void)testMappingEmptyAndMissingFiles
+{
+  NSString *path = [self temporaryFileWithData:[NSData data]];
+  NSError *error;
+  PINBuffer *buffer = [[PINBuffer alloc] initWithContentsOfFile:path error:&error];
+  XCTAssertNotNil(buffer, @"%@", error);
+  XCTAssertTrue([buffer isAtEnd]);
+  XCTAssertNotNil([[PINMessageUnpacker alloc] initWithContentsOfFile:path error:&error], @"%@", error);
+
+  NSString *missingPath = [path stringByAppendingString:@".missing"];
+  XCTAssertNil([[PINMessageUnpacker alloc] initWithContentsOfFile:missingPath error:&error]);
+  XCTAssertEqualObjects(error.domain, NSPOSIXErrorDomain);
+  XCTAssertEqual(error.code, ENOENT);
+  error = nil;
+  XCTAssertNil([[PINBuffer alloc] initWithContentsOfFile:missingPath error:&error]);
+  XCTAssertEqual(error.code, ENOENT);
+}
+
 - (void)testARealResponse
 {
   // Read the ref object from the plist in our bundle.
@@ -223,6 +1324,18 @@ static size_t stream_writer(cmp_ctx_t *ctx, const void *data, size_t count)
   XCTAssertEqualObjects(obj, refObject);
 }
 
+- (void)testARealResponseFromData
+{
+  NSString *refPath = [[NSBundle bundleForClass:self.class] pathForResource:@"MessagePackRefObject" ofType:@"plist"];
+  id refObject = [NSKeyedUnarchiver unarchiveObjectWithFile:refPath];
+  XCTAssertNotNil(refObject);
+  
+  PINMessageUnpacker *u = [[PINMessageUnpacker alloc] initWithData:[self performanceMessagePackData]];
+  id obj = [u decodeObjectOfClass:Nil];
+  XCTAssertNil(u.error);
+  XCTAssertEqualObjects(obj, refObject);
+}
+
 - (NSData *)performanceMessagePackData NS_RETURNS_RETAINED
 {
   static NSData *msgPackData;
@@ -291,6 +1404,180 @@ static size_t stream_writer(cmp_ctx_t *ctx, const void *data, size_t count)
   }];
 }
 
+- (void)testMessagePackFromDataPerformance
+{
+  NSData *msgPackData = [self performanceMessagePackData];
+  
+  [self measureBlock:^{
+    @autoreleasepool {
+      dispatch_apply(4, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^(size_t i) {
+        @autoreleasepool {
+          [[[PINMessageUnpacker alloc] initWithData:msgPackData] decodeObjectOfClass:Nil];
+        }
+      });
+    }
+  }];
+}
+
+/// A list of maps whose keys and values are all strings, like a feed of text-heavy items.
+- (NSData *)stringHeavyMessagePackDataWithSample:(NSString *)sample
+{
+  NSMutableArray *items = [NSMutableArray array];
+  for (NSInteger i = 0; i < 20000; i++) {
+    [items addObject:@{ @"title": [NSString stringWithFormat:@"%@ %ld", sample, (long)i],
+                        @"description": [sample stringByAppendingString:sample],
+                        @"url": [NSString stringWithFormat:@"https://example.com/pin/%ld", (long)i] }];
+  }
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:items];
+  return [NSData dataWithData:[packer encodedData]];
+}
+
+- (void)testASCIIStringDecodingPerformance
+{
+  NSData *data = [self stringHeavyMessagePackDataWithSample:@"A photo of a mountain lake at sunrise, with pines"];
+  [self measureBlock:^{
+    @autoreleasepool {
+      [[[PINMessageUnpacker alloc] initWithData:data] decodeObjectOfClass:Nil];
+    }
+  }];
+}
+
+- (void)testNonASCIIStringDecodingPerformance
+{
+  NSData *data = [self stringHeavyMessagePackDataWithSample:@"Un café près du lac à l'aube, avec des pins 🌲"];
+  [self measureBlock:^{
+    @autoreleasepool {
+      [[[PINMessageUnpacker alloc] initWithData:data] decodeObjectOfClass:Nil];
+    }
+  }];
+}
+
+- (void)testDecodingASCIIAndNonASCIIStrings
+{
+  NSArray *strings = @[ @"", @"plain ascii that is longer than sixteen bytes", @"café", @"ascii prefix longer than sixteen bytes, then ü", @"🌲" ];
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:strings];
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+  XCTAssertEqualObjects([unpacker decodeObjectOfClass:Nil], strings);
+  XCTAssertNil(unpacker.error);
+}
+
+/// A map holding a long list of independent items.
+- (NSData *)largeArrayMessagePackData
+{
+  NSMutableArray *items = [NSMutableArray array];
+  for (NSInteger i = 0; i < 50000; i++) {
+    [items addObject:@{ @"id": @(i), @"title": [NSString stringWithFormat:@"Item %ld", (long)i], @"tags": @[ @"a", @"b", @(i % 7) ], @"score": @(i * 0.5) }];
+  }
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:@{ @"data": items, @"bookmark": @"next" }];
+  return [NSData dataWithData:[packer encodedData]];
+}
+
+- (void)testConcurrentDecodingMatchesSerialDecoding
+{
+  NSData *data = [self largeArrayMessagePackData];
+  NSDictionary *serial = [[[PINMessageUnpacker alloc] initWithData:data] decodeObjectOfClass:Nil];
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:data];
+  unpacker.decodingConcurrency = 4;
+  NSDictionary *concurrent = [unpacker decodeObjectOfClass:Nil];
+  XCTAssertNil(unpacker.error);
+  XCTAssertEqual([concurrent[@"data"] count], 50000);
+  XCTAssertEqualObjects(concurrent, serial);
+}
+
+- (void)testConcurrentDecodingCollectsTheSameStatistics
+{
+  NSData *data = [self largeArrayMessagePackData];
+  PINMessageUnpacker *serial = [[PINMessageUnpacker alloc] initWithData:data];
+  serial.collectsStatistics = YES;
+  [serial decodeObjectOfClass:Nil];
+  PINMessageUnpacker *concurrent = [[PINMessageUnpacker alloc] initWithData:data];
+  concurrent.collectsStatistics = YES;
+  concurrent.decodingConcurrency = 4;
+  [concurrent decodeObjectOfClass:Nil];
+  XCTAssertNil(concurrent.error);
+
+  const PINDecodingStatistics expected = serial.statistics;
+  const PINDecodingStatistics actual = concurrent.statistics;
+  XCTAssertEqual(actual.messageCount, 1);
+  XCTAssertEqual(actual.messageCount, expected.messageCount);
+  for (NSUInteger type = 0; type < PINMessagePackTypeCount; type++) {
+    XCTAssertEqual(actual.objectCounts[type], expected.objectCounts[type]);
+  }
+  XCTAssertEqual(actual.maximumDepth, expected.maximumDepth);
+  XCTAssertEqual(actual.largestContainerCount, expected.largestContainerCount);
+}
+
+- (void)measureDecodingWithConcurrency:(NSUInteger)concurrency
+{
+  NSData *data = [self largeArrayMessagePackData];
+  [self measureBlock:^{
+    @autoreleasepool {
+      PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:data];
+      unpacker.decodingConcurrency = concurrency;
+      [unpacker decodeObjectOfClass:Nil];
+    }
+  }];
+}
+
+- (void)testDecodingPerformanceOn1Core
+{
+  [self measureDecodingWithConcurrency:1];
+}
+
+- (void)testDecodingPerformanceOn2Cores
+{
+  [self measureDecodingWithConcurrency:2];
+}
+
+- (void)testDecodingPerformanceOn4Cores
+{
+  [self measureDecodingWithConcurrency:4];
+}
+
+- (void)testDecodingPerformanceOnAllCores
+{
+  [self measureDecodingWithConcurrency:[NSProcessInfo processInfo].activeProcessorCount];
+}
+
+- (void)measureBufferThroughputWithChunkSize:(NSUInteger)chunkSize
+{
+  const NSUInteger totalSize = 16 * 1024 * 1024;
+  NSData *chunk = [NSMutableData dataWithLength:chunkSize];
+  
+  [self measureBlock:^{
+    PINBuffer *buf = [[PINBuffer alloc] init];
+    // Write from another thread, like NSURLSession would.
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+      for (NSUInteger written = 0; written < totalSize; written += chunkSize) {
+        [buf writeData:chunk];
+      }
+      [buf closeCompleted:YES];
+    });
+    
+    // Read in small pieces, like the unpacker does.
+    uint8_t bytes[8];
+    while ([buf read:bytes length:sizeof(bytes)]) {}
+  }];
+}
+
+- (void)testBufferPerformanceWith64ByteChunks
+{
+  [self measureBufferThroughputWithChunkSize:64];
+}
+
+- (void)testBufferPerformanceWith4KBChunks
+{
+  [self measureBufferThroughputWithChunkSize:4096];
+}
+
+- (void)testBufferPerformanceWith64KBChunks
+{
+  [self measureBufferThroughputWithChunkSize:65536];
+}
+
 - (void)testThatItReadsLargeS8sCorrectly
 {
   SInt8 val = INT8_MAX;
@@ -371,6 +1658,187 @@ static size_t stream_writer(cmp_ctx_t *ctx, const void *data, size_t count)
   XCTAssertEqualObjects(obj, @(val));
 }
 
+- (void)testPackingRoundTrip
+{
+  NSDictionary *object = @{ @"string" : @"Hello",
+                            @"unicode" : @"Caf\u00e9 \U0001F600",
+                            @"int" : @(-42),
+                            @"bigUnsigned" : @(UINT64_MAX),
+                            @"double" : @(1.5),
+                            @"bool" : @YES,
+                            @"data" : [NSData dataWithBytes:"\x01\x02\x03" length:3],
+                            @"array" : @[ @1, @"two", @[ @3 ] ],
+                            @"null" : [NSNull null] };
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:object];
+  XCTAssertNil(packer.error);
+
+  PINBuffer *buf = [[PINBuffer alloc] init];
+  [buf writeData:[packer encodedData]];
+  [buf closeCompleted:YES];
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithBuffer:buf];
+  XCTAssertEqualObjects([unpacker decodeObjectOfClass:Nil], object);
+  XCTAssertNil(unpacker.error);
+}
+
+- (void)testPackingStringsWithNULs
+{
+  NSArray *strings = @[ [NSString stringWithCharacters:(const unichar[]){ 'a', 0, 'b' } length:3],
+                        [NSString stringWithCharacters:(const unichar[]){ 0xe9, 0, 0xe9 } length:3] ];
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:strings];
+  XCTAssertNil(packer.error);
+
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+  NSArray *decoded = [unpacker decodeArrayOfClass:[NSString class]];
+  XCTAssertNil(unpacker.error);
+  XCTAssertEqualObjects(decoded, strings);
+  XCTAssertEqual([decoded[0] length], 3);
+}
+
+- (void)testPackingIntoABufferInSmallChunks
+{
+  NSMutableArray *strings = [NSMutableArray array];
+  for (NSInteger i = 0; i < 100; i++) {
+    [strings addObject:[NSString stringWithFormat:@"String number %ld", (long)i]];
+  }
+  PINBuffer *buf = [[PINBuffer alloc] init];
+  PINMessagePacker *packer = [[PINMessagePacker alloc] initWithBuffer:buf chunkSize:16];
+  [packer encodeObject:strings];
+  [packer flush];
+  [buf closeCompleted:YES];
+
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithBuffer:buf];
+  XCTAssertEqualObjects([unpacker decodeArrayOfClass:[NSString class]], strings);
+  XCTAssertNil(unpacker.error);
+}
+
+- (void)testPackingACustomClass
+{
+  PINTestPoint *point = [[PINTestPoint alloc] init];
+  point.x = 7;
+  point.y = 2.25;
+  point.name = @"origin-ish";
+  PINMessagePacker *packer = [[PINMessagePacker alloc] initWithBuffer:writeBuffer];
+  [packer encodeObject:point];
+  [packer flush];
+
+  PINTestPoint *decoded = [u decodeObjectOfClass:[PINTestPoint class]];
+  XCTAssertNil(u.error);
+  XCTAssertEqual(decoded.x, 7);
+  XCTAssertEqual(decoded.y, 2.25);
+  XCTAssertEqualObjects(decoded.name, @"origin-ish");
+}
+
+- (void)testDecodingWithAPlan
+{
+  PINTestPoint *location = [[PINTestPoint alloc] init];
+  location.x = 3;
+  location.name = @"home";
+  NSDictionary *user = @{
+    @"id": @(1LL << 40),
+    @"age": @30,
+    @"verified": @YES,
+    @"score": @0.5,
+    @"name": @"Ada",
+    @"unknown": @{ @"nested": @[ @1, @2 ] },
+    @"location": location
+  };
+  PINMessagePacker *packer = [[PINMessagePacker alloc] initWithBuffer:writeBuffer];
+  [packer encodeObject:user];
+  [packer flush];
+  
+  PINTestPlannedUser *decoded = [u decodeObjectOfClass:[PINTestPlannedUser class]];
+  XCTAssertNil(u.error);
+  XCTAssertEqual(decoded->_identifier, 1LL << 40);
+  XCTAssertEqual(decoded->_age, 30);
+  XCTAssertTrue(decoded->_verified);
+  XCTAssertEqual(decoded->_score, 0.5f);
+  XCTAssertEqualObjects(decoded->_name, @"Ada");
+  XCTAssertEqual(decoded->_location.x, 3);
+  XCTAssertEqualObjects(decoded->_location.name, @"home");
+}
+
+- (void)testDecodingWithAPlanRejectsIntegersThatDontFit
+{
+  for (NSNumber *age in @[ @256, @-1 ]) {
+    PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+    [packer encodeObject:@{ @"age": age }];
+    PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+    __block PINTestPlannedUser *decoded;
+    [self ignoringAssertions:^{
+      decoded = [unpacker decodeObjectOfClass:[PINTestPlannedUser class]];
+    }];
+    XCTAssertEqual(unpacker.error.code, PINMessagePackErrorInvalidType);
+    XCTAssertEqual(decoded ? decoded->_age : 0, 0);
+  }
+}
+
+- (void)testDecodingPlansSkipWeakIvars
+{
+  __block PINDecodingPlan *plan;
+  [self ignoringAssertions:^{
+    plan = [[PINDecodingPlan alloc] initWithClass:[PINTestWeakReferrer class]
+                                     ivarsForKeys:@{ @"target": @"_target", @"name": @"_name" }
+                                   classesForKeys:@{}];
+  }];
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:@{ @"target": @"dangling", @"name": @"kept" }];
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+  PINTestWeakReferrer *referrer = [[PINTestWeakReferrer alloc] init];
+  [unpacker decodeMapIntoObject:referrer withPlan:plan];
+  XCTAssertNil(unpacker.error);
+  XCTAssertNil(referrer->_target);
+  XCTAssertEqualObjects(referrer->_name, @"kept");
+}
+
+- (void)testDecodingNumericArrays
+{
+  NSMutableArray *ints = [NSMutableArray array];
+  for (NSInteger i = 0; i < 1000; i++) {
+    // Runs of int32, then fixints, then int64.
+    [ints addObject:@(i < 400 ? -100000 - i : (i < 700 ? i % 100 : (1LL << 40) + i))];
+  }
+  NSArray *floats = @[ @0.5f, @1.5f, @2, @-3.25 ];
+  PINMessagePacker *packer = [[PINMessagePacker alloc] init];
+  [packer encodeObject:ints];
+  [packer encodeObject:floats];
+  [packer encodeObject:floats];
+  PINMessageUnpacker *unpacker = [[PINMessageUnpacker alloc] initWithData:[packer encodedData]];
+  
+  NSData *intData = [unpacker decodeInt64Array];
+  XCTAssertEqual(intData.length, ints.count * sizeof(int64_t));
+  const int64_t *values = intData.bytes;
+  for (NSUInteger i = 0; i < ints.count; i++) {
+    XCTAssertEqual(values[i], [ints[i] longLongValue]);
+  }
+  float floatValues[4];
+  XCTAssertEqual([unpacker decodeFloatArray:floatValues maxCount:4], 4);
+  XCTAssertEqual(floatValues[1], 1.5f);
+  XCTAssertEqual(floatValues[2], 2.0f);
+  XCTAssertEqual(floatValues[3], -3.25f);
+  double doubleValues[4];
+  XCTAssertEqual([unpacker decodeDoubleArray:doubleValues maxCount:4], 4);
+  XCTAssertEqual(doubleValues[3], -3.25);
+  XCTAssertNil(unpacker.error);
+}
+
+- (void)testDecodingNumericArraysAcrossChunks
+{
+  XCTAssertTrue(cmp_write_array(&writeCtx, 3));
+  XCTAssertTrue(cmp_write_s32(&writeCtx, -70000));
+  XCTAssertTrue(cmp_write_double(&writeCtx, 0.25));
+  XCTAssertTrue(cmp_write_u8(&writeCtx, 200));
+  [writeBuffer closeCompleted:YES];
+  
+  double values[3];
+  XCTAssertEqual([u decodeDoubleArray:values maxCount:3], 3);
+  XCTAssertEqual(values[0], -70000);
+  XCTAssertEqual(values[1], 0.25);
+  XCTAssertEqual(values[2], 200);
+  XCTAssertNil(u.error);
+}
+
 - (NSData *)messagePackDataWithBlock:(void(^)(cmp_ctx_t *ctx))block
 {
   PINBuffer *buf = [[PINBuffer alloc] init];